@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <initializer_list>
+
+namespace ktu {
+    namespace charclass {
+
+        enum : uint8_t {
+            bin             = 1 << 0,
+            oct             = 1 << 1,
+            dec             = 1 << 2,
+            hex             = 1 << 3,
+            variable_start  = 1 << 4,
+            variable        = 1 << 5,
+            space           = 1 << 6
+        };
+
+        /* Class bits of every byte value. */
+        inline constexpr std::array<uint8_t, 256> table = [] {
+            std::array<uint8_t, 256> result = {};
+            for (unsigned c = '0'; c <= '9'; c++)
+                result[c] = dec | hex | variable | ((c <= '7') ? oct : 0) | ((c <= '1') ? bin : 0);
+            for (unsigned c = 'a'; c <= 'z'; c++) {
+                result[c] = variable_start | variable | ((c <= 'f') ? hex : 0);
+                result[c - 0x20] = result[c];
+            }
+            result['_'] = variable_start | variable;
+            for (unsigned c : {' ', '\t', '\n', '\v', '\f', '\r'})
+                result[c] = space;
+            return result;
+        }();
+
+        /* Value of every byte as a digit up to base 16, 0xFF for non digits. */
+        inline constexpr std::array<uint8_t, 256> digit = [] {
+            std::array<uint8_t, 256> result = {};
+            for (auto &value : result)
+                value = 0xFF;
+            for (unsigned c = '0'; c <= '9'; c++)
+                result[c] = c - '0';
+            for (unsigned c = 'a'; c <= 'f'; c++)
+                result[c] = result[c - 0x20] = c - 'a' + 10;
+            return result;
+        }();
+
+        inline constexpr bool is(const char c, uint8_t cls) {
+            return table[(uint8_t)c] & cls;
+        }
+    };
+
+    namespace impl {
+        template <unsigned base>
+        inline constexpr unsigned long readDigits(const char *&ptr, long size) {
+            unsigned long ret = 0;
+            while (size--) {
+                uint8_t cur = charclass::digit[(uint8_t)*ptr];
+                if (cur >= base) return ret;
+                ptr++;
+                ret = (ret * base) + cur;
+            }
+            return ret;
+        }
+    };
+
+    inline constexpr unsigned long readBin(const char *&ptr, long size = -1) {return impl::readDigits<2>(ptr, size);}
+    inline constexpr bool isBin(const char c) {return charclass::is(c, charclass::bin);}
+
+    inline constexpr unsigned long readOct(const char *&ptr, long size = -1) {return impl::readDigits<8>(ptr, size);}
+    inline constexpr bool isOct(const char c) {return charclass::is(c, charclass::oct);}
+
+    inline constexpr unsigned long readDec(const char *&ptr, long size = -1) {return impl::readDigits<10>(ptr, size);}
+    inline constexpr bool isDec(const char c) {return charclass::is(c, charclass::dec);}
+
+    inline constexpr unsigned long readHex(const char *&ptr, long size = -1) {return impl::readDigits<16>(ptr, size);}
+    inline constexpr bool isHex(const char c) {return charclass::is(c, charclass::hex);}
+
+    inline constexpr bool isVariableStart(const char c) {return charclass::is(c, charclass::variable_start);}
+    inline constexpr bool isVariable(const char c) {return charclass::is(c, charclass::variable);}
+    inline constexpr bool isSpace(const char c) {return charclass::is(c, charclass::space);}
+
+    /* Returns the end of the identifier at ptr, or ptr if it does not start one.
+        The input must be terminated by a non identifier character.
+    */
+    inline constexpr const char *readVariable(const char *ptr) {
+        if (!isVariableStart(*ptr))
+            return ptr;
+        while (isVariable(*++ptr));
+        return ptr;
+    }
+
+    /* Bounded scanners, each returns the end of the run starting at ptr and never reads at or past last.
+        Input is classified 16 bytes at a time.
+    */
+    const char *scanVariable(const char *ptr, const char *last);
+    const char *scanBin(const char *ptr, const char *last);
+    const char *scanOct(const char *ptr, const char *last);
+    const char *scanDec(const char *ptr, const char *last);
+    const char *scanHex(const char *ptr, const char *last);
+    const char *scanSpace(const char *ptr, const char *last);
+};
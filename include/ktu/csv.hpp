@@ -0,0 +1,145 @@
+#pragma once
+#include <ktu/memory/view.hpp>
+#include <ktu/memory/reader.hpp>
+#include <ktu/simd.hpp>
+#include <string>
+#include <iterator>
+
+namespace ktu {
+    namespace csv {
+
+        struct field {
+            /* Contents of the field, with the surrounding quotes and a trailing '\r' removed.
+                Points into the tokenized input.
+            */
+            view data;
+            /* The field was enclosed in quotes. */
+            bool quoted = false;
+            /* The field contains doubled quotes, data must be passed through unescape to get its value. */
+            bool escaped = false;
+            /* The field is the last one of its record. */
+            bool last = false;
+
+            inline size_t size() const {return data.size();}
+            inline std::string_view string_view() const {return std::string_view(data.begin<char>(), data.size());}
+        };
+
+        /* Collapses every doubled quote in the field, the result is the value the field represents. */
+        std::string unescape(const view &data, char quote = '"');
+        inline std::string unescape(const field &f, char quote = '"') {
+            return (f.escaped) ? unescape(f.data, quote) : std::string(f.string_view());
+        }
+
+        /* Splits delimited text into fields without copying.
+            Delimiter, quote and newline positions are found 64 bytes at a time as bitmasks,
+                bytes between quotes are masked out with a prefix xor so quoted delimiters and newlines are skipped.
+            Records end at '\n', a '\r' directly before it is dropped.
+            A quote value of zero disables quoting, which is what most TSV files expect.
+        */
+        class tokenizer {
+            public:
+                class iterator {
+                    public:
+                        using iterator_category = std::input_iterator_tag;
+                        using value_type = field;
+                        using difference_type = std::ptrdiff_t;
+                        using pointer = const field*;
+                        using reference = const field&;
+
+                        iterator() : parent(nullptr) {}
+                        iterator(tokenizer *parent) : parent(parent) {
+                            if (parent && !parent->next())
+                                this->parent = nullptr;
+                        }
+
+                        inline reference operator*() const {return parent->current;}
+                        inline pointer operator->() const {return &parent->current;}
+
+                        inline iterator &operator++() {
+                            if (!parent->next())
+                                parent = nullptr;
+                            return *this;
+                        }
+                        inline void operator++(int) {++*this;}
+
+                        inline bool operator==(const iterator &rhs) const {return parent == rhs.parent;}
+                        inline bool operator!=(const iterator &rhs) const {return parent != rhs.parent;}
+
+                    private:
+                        tokenizer *parent;
+                };
+
+                tokenizer(const view &input, char delimiter = ',', char quote = '"') :
+                    first(input.begin()), last(input.end()), start(input.begin()),
+                    delimiter(delimiter), quote(quote) {}
+                /* Tokenizes the unread part of the reader. */
+                tokenizer(reader &input, char delimiter = ',', char quote = '"') :
+                    tokenizer(view(input.cur(), input.end()), delimiter, quote) {}
+
+                /* Advances to the next field, returns false once the input is exhausted. */
+                inline bool next() {
+                    while (!structurals) {
+                        if (indexed >= (size_t)(last - first))
+                            return finish();
+                        index();
+                    }
+                    const uint8_t *position = first + (indexed - simd::width + simd::pop_lowest(structurals));
+                    emit(position, *position == '\n');
+                    start = position + 1;
+                    trailing = (*position != '\n');
+                    return true;
+                }
+
+                /* The field found by the last call to next. */
+                inline const field &get() const {return current;}
+
+                /* Position the next field will start at. */
+                inline const uint8_t *position() const {return start;}
+
+                inline iterator begin() {return iterator(this);}
+                inline iterator end() {return iterator();}
+
+            private:
+                /* Classifies the next 64 bytes. */
+                void index();
+                bool finish();
+
+                inline void emit(const uint8_t *end, bool record_end) {
+                    const uint8_t *begin = start;
+                    if (record_end && end > begin && end[-1] == '\r')
+                        --end;
+                    current.quoted = current.escaped = false;
+                    if (quote && begin < end && *begin == (uint8_t)quote) {
+                        current.quoted = true;
+                        ++begin;
+                        if (end > begin && end[-1] == (uint8_t)quote)
+                            --end;
+                        current.escaped = memchr(begin, quote, end - begin) != nullptr;
+                    }
+                    current.data = view(begin, end);
+                    current.last = record_end;
+                }
+
+                const uint8_t *first;
+                const uint8_t *last;
+                const uint8_t *start;
+                /* Number of bytes that have been classified. */
+                size_t indexed = 0;
+                /* Unconsumed delimiter and newline bits of the last classified block. */
+                uint64_t structurals = 0;
+                /* All ones if the previous block ended inside quotes. */
+                uint64_t inside = 0;
+                /* The last structural was a delimiter, so an (empty) field still follows it. */
+                bool trailing = false;
+                char delimiter;
+                char quote;
+                field current;
+        };
+
+        /* Tokenizes tab separated values, quoting is disabled. */
+        inline tokenizer tsv(const view &input) {
+            return tokenizer(input, '\t', 0);
+        }
+
+    };
+};
@@ -0,0 +1,249 @@
+#ifndef KTU__FRONT_CODED_MULTI_STRING_HPP
+#define KTU__FRONT_CODED_MULTI_STRING_HPP
+#include <algorithm>
+#include <cstddef>
+#include <concepts>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <ktu/multi_string.hpp>
+
+namespace ktu {
+/* An immutable sequence of sorted strings, front coded in buckets of bucket_size strings.
+    A bucket begins with its head, its size and characters, and every other string is stored as the size of the prefix
+        it shares with the string before it, the size of the rest and its characters. Sizes are varints of 7 bits per character.
+    Lookups binary search the heads and then decode a single bucket, strings are decoded in order by the iterator.
+*/
+template <
+    class CharT
+> class basic_front_coded_multi_string {
+    public:
+    using char_type = CharT;
+    using size_type = size_t;
+    using ssize_type = ssize_t;
+    using string_type = std::basic_string<char_type>;
+    using string_view_type = std::basic_string_view<char_type>;
+    static constexpr size_type npos = string_type::npos;
+
+    /* Decodes the strings in order, the view it returns lasts until it is incremented. */
+    class const_iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = string_view_type;
+            using difference_type = ssize_type;
+            const_iterator(const basic_front_coded_multi_string &parent, size_type pos) : priv{.pos=pos,.parent=&parent,.ptr=nullptr,.string={}} {
+                if (pos < parent.size())
+                    seek();
+            }
+            const_iterator &operator++() {
+                if (++priv.pos < priv.parent->size()) {
+                    if (priv.pos % priv.parent->bucket_size())
+                        priv.parent->priv.next(priv.ptr, priv.string);
+                    else
+                        seek();
+                }
+                return *this;
+            }
+            const_iterator operator++(int) {
+                const_iterator prev = *this;
+                ++(*this);
+                return prev;
+            }
+            string_view_type operator*() const {
+                return priv.string;
+            }
+            bool operator==(const const_iterator &other) const {
+                return priv.pos == other.priv.pos;
+            }
+            size_type index() const {
+                return priv.pos;
+            }
+        private:
+            void seek() {
+                priv.ptr = priv.parent->priv.head(priv.pos / priv.parent->bucket_size(), priv.string);
+                for (size_type i = priv.pos % priv.parent->bucket_size(); i; --i)
+                    priv.parent->priv.next(priv.ptr, priv.string);
+            }
+            struct priv {
+                size_type pos;
+                const basic_front_coded_multi_string *parent;
+                const char_type *ptr = nullptr;
+                string_type string;
+            } priv;
+    };
+
+    private:
+    using unit_type = std::make_unsigned_t<char_type>;
+    struct priv {
+        string_type data;
+        /* Index of each bucket in data. */
+        std::vector<size_type> buckets;
+        size_type count = 0;
+        size_type bucketSize = 16;
+
+        static void put(string_type &out, size_type value) {
+            for (; value >= 0x80; value >>= 7)
+                out.push_back(char_type((value & 0x7F) | 0x80));
+            out.push_back(char_type(value));
+        }
+        static size_type get(const char_type *&ptr) {
+            size_type value = 0;
+            for (unsigned shift = 0;; shift += 7) {
+                unit_type unit = *ptr++;
+                value |= size_type(unit & 0x7F) << shift;
+                if (!(unit & 0x80))
+                    return value;
+            }
+        }
+        string_view_type head(size_type bucket) const {
+            const char_type *ptr = data.data() + buckets[bucket];
+            size_type size = get(ptr);
+            return string_view_type(ptr, size);
+        }
+        /* Reads the head of the bucket into string and returns where the next string begins. */
+        const char_type *head(size_type bucket, string_type &string) const {
+            string_view_type view = head(bucket);
+            string.assign(view);
+            return view.data() + view.size();
+        }
+        /* Reads the string after the one in string. */
+        static void next(const char_type *&ptr, string_type &string) {
+            size_type shared = get(ptr), size = get(ptr);
+            string.resize(shared);
+            string.append(ptr, size);
+            ptr += size;
+        }
+        void push(string_view_type str, string_view_type prev) {
+            if (count && str < prev)
+                throw std::invalid_argument("Strings of a front_coded_multi_string must be sorted.");
+            if (!(count % bucketSize)) {
+                buckets.push_back(data.size());
+                put(data, str.size());
+                data.append(str);
+            } else {
+                size_type shared = std::mismatch(str.begin(), str.begin() + std::min(str.size(), prev.size()), prev.begin()).first - str.begin();
+                put(data, shared);
+                put(data, str.size() - shared);
+                data.append(str.substr(shared));
+            }
+            ++count;
+        }
+    } priv;
+
+    public:
+    /*`Main`*/
+        basic_front_coded_multi_string() {}
+        /* Encodes sorted strings, throws std::invalid_argument if they are not sorted. */
+        template <class InputIt>
+        basic_front_coded_multi_string(InputIt first, InputIt last, size_type bucket_size = 16) {
+            if (!bucket_size)
+                throw std::invalid_argument("Bucket size of a front_coded_multi_string must not be zero.");
+            priv.bucketSize = bucket_size;
+            string_type prev;
+            for (InputIt it = first; it != last; ++it) {
+                string_view_type str = *it;
+                priv.push(str, prev);
+                prev.assign(str);
+            }
+            priv.data.shrink_to_fit();
+            priv.buckets.shrink_to_fit();
+        }
+        template <std::unsigned_integral U, bool packed>
+        basic_front_coded_multi_string(const basic_multi_string<char_type, U, packed> &strings, size_type bucket_size = 16)
+            : basic_front_coded_multi_string(strings.begin(), strings.end(), bucket_size) {}
+        basic_front_coded_multi_string(std::initializer_list<string_view_type> init, size_type bucket_size = 16)
+            : basic_front_coded_multi_string(init.begin(), init.end(), bucket_size) {}
+
+    /*`Element Access`*/
+        string_type at(size_type pos) const {
+            if (pos >= priv.count) {
+                throw std::out_of_range("Index out of bounds.");
+            }
+            return (*this)[pos];
+        }
+        /* Decodes the string, up to bucket_size - 1 strings before it in its bucket. */
+        string_type operator[](size_type pos) const {
+            return string_type(*const_iterator(*this, pos));
+        }
+        string_type front() const {
+            return (*this)[0];
+        }
+        string_type back() const {
+            return (*this)[priv.count - 1];
+        }
+
+    /*`Iterators`*/
+        const_iterator begin() const {
+            return const_iterator(*this, 0);
+        }
+        const_iterator end() const {
+            return const_iterator(*this, priv.count);
+        }
+
+    /*`Capacity`*/
+        bool empty() const {
+            return !priv.count;
+        }
+        size_type size() const {
+            return priv.count;
+        }
+        size_type bucket_size() const {
+            return priv.bucketSize;
+        }
+        size_type bucket_count() const {
+            return priv.buckets.size();
+        }
+        /* Characters taken by the encoded strings. */
+        size_type encoded_size() const {
+            return priv.data.size();
+        }
+
+    /*`Lookup`*/
+        /* Position of the first string not less than value. */
+        size_type lower_bound(string_view_type value) const {
+            // The last bucket whose head is less than value holds the position, or it is the head of the next one.
+            size_type low = 0, high = priv.buckets.size();
+            while (low < high) {
+                size_type mid = low + (high - low) / 2;
+                if (priv.head(mid) < value)
+                    low = mid + 1;
+                else
+                    high = mid;
+            }
+            if (!low)
+                return 0;
+            size_type bucket = low - 1, pos = bucket * priv.bucketSize, last = std::min(pos + priv.bucketSize, priv.count);
+            string_type string;
+            const char_type *ptr = priv.head(bucket, string);
+            for (++pos; pos < last; ++pos) {
+                priv.next(ptr, string);
+                if (!(string_view_type(string) < value))
+                    return pos;
+            }
+            return pos;
+        }
+        /* Position of the string, or npos. */
+        size_type find(string_view_type value) const {
+            size_type pos = lower_bound(value);
+            return (pos < priv.count && (*this)[pos] == value) ? pos : npos;
+        }
+        bool contains(string_view_type value) const {
+            return find(value) != npos;
+        }
+        void swap(basic_front_coded_multi_string &other) {
+            std::swap(priv, other.priv);
+        }
+};
+
+using front_coded_multi_string = basic_front_coded_multi_string<char>;
+using wfront_coded_multi_string = basic_front_coded_multi_string<wchar_t>;
+using u8front_coded_multi_string = basic_front_coded_multi_string<char8_t>;
+using u16front_coded_multi_string = basic_front_coded_multi_string<char16_t>;
+using u32front_coded_multi_string = basic_front_coded_multi_string<char32_t>;
+
+};
+#endif
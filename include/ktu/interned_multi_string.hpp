@@ -0,0 +1,242 @@
+#ifndef KTU__INTERNED_MULTI_STRING_HPP
+#define KTU__INTERNED_MULTI_STRING_HPP
+#include <cstddef>
+#include <cstdint>
+#include <concepts>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+#include <ktu/algorithm.hpp>
+#include <ktu/multi_string.hpp>
+
+namespace ktu {
+/* A sequence of strings that stores every distinct string once.
+    Each distinct string has a stable id, the position of its node in the multi_string of unique strings,
+        so entries are equal exactly when their ids are.
+    Unique strings are found through an open addressing table with linear probing,
+        whose slots hold an id and the upper half of the hash of its string.
+*/
+template <
+    class CharT,
+    std::unsigned_integral IdT = uint32_t
+> class basic_interned_multi_string {
+    public:
+    using char_type = CharT;
+    using id_type = IdT;
+    using size_type = size_t;
+    using ssize_type = ssize_t;
+    using string_view_type = std::basic_string_view<char_type>;
+    using multi_string_type = basic_multi_string<char_type>;
+    static constexpr id_type npos = std::numeric_limits<id_type>::max();
+
+    class const_iterator {
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using iterator_concept = std::random_access_iterator_tag;
+            const_iterator(const basic_interned_multi_string &parent, const id_type *data) : priv{.data=data,.parent=parent} {}
+            const_iterator &operator++() {
+                ++priv.data;
+                return *this;
+            }
+            const_iterator &operator--() {
+                --priv.data;
+                return *this;
+            }
+            const_iterator &operator+=(ssize_type diff) {
+                priv.data += diff;
+                return *this;
+            }
+            const_iterator &operator-=(ssize_type diff) {
+                priv.data -= diff;
+                return *this;
+            }
+            friend size_type operator-(const_iterator lhs, const_iterator rhs) {
+                return lhs.priv.data - rhs.priv.data;
+            }
+            friend const_iterator operator+(const_iterator obj, ssize_type diff) {
+                return const_iterator(obj.priv.parent, obj.priv.data + diff);
+            }
+            friend const_iterator operator-(const_iterator obj, ssize_type diff) {
+                return const_iterator(obj.priv.parent, obj.priv.data - diff);
+            }
+            string_view_type operator*() const {
+                return priv.parent.priv.strings[*priv.data];
+            }
+            bool operator==(const const_iterator &other) const {
+                return priv.data == other.priv.data;
+            }
+            std::weak_ordering operator<=>(const const_iterator &other) const {
+                return priv.data <=> other.priv.data;
+            }
+            id_type id() const {
+                return *priv.data;
+            }
+        private:
+            struct priv {
+                const id_type *data;
+                const basic_interned_multi_string &parent;
+            } priv;
+    };
+
+    private:
+    struct slot {
+        id_type id;
+        uint32_t hash;
+    };
+    struct priv {
+        multi_string_type strings;
+        std::vector<id_type> ids;
+        std::vector<slot> table = std::vector<slot>(16, slot{npos, 0});
+        unsigned bits = 4;
+
+        /* Upper half of the hash after a Fibonacci multiplication, the last characters barely reach the top bits of FNV-1a. */
+        static uint32_t hash(string_view_type str) {
+            return (ktu::hash((const void*)str.data(), str.size() * sizeof(char_type)) * 0x9E3779B97F4A7C15ULL) >> 32;
+        }
+        /* Slot of the string, or the empty slot where it belongs. */
+        size_type probe(string_view_type str, uint32_t hash) const {
+            for (size_type i = hash >> (32 - bits), mask = table.size() - 1;; i = (i + 1) & mask) {
+                const slot &s = table[i];
+                if (s.id == npos || (s.hash == hash && strings[s.id] == str))
+                    return i;
+            }
+        }
+        void grow() {
+            std::vector<slot> old(table.size() * 2, slot{npos, 0});
+            old.swap(table);
+            ++bits;
+            for (const slot &s : old) {
+                if (s.id == npos)
+                    continue;
+                size_type i = s.hash >> (32 - bits), mask = table.size() - 1;
+                while (table[i].id != npos)
+                    i = (i + 1) & mask;
+                table[i] = s;
+            }
+        }
+        id_type intern(string_view_type str) {
+            uint32_t h = hash(str);
+            size_type i = probe(str, h);
+            if (table[i].id != npos)
+                return table[i].id;
+            if (strings.size() >= npos)
+                throw std::length_error("Too many unique strings for the id type.");
+            id_type id = strings.size();
+            strings.push_back(str);
+            table[i] = slot{id, h};
+            if (strings.size() * 4 > table.size() * 3)
+                grow();
+            return id;
+        }
+    } priv;
+
+    public:
+    /*`Main`*/
+        basic_interned_multi_string() {}
+        template <class InputIt>
+        basic_interned_multi_string(InputIt first, InputIt last) {
+            for (InputIt it = first; it != last; ++it) {
+                push_back(*it);
+            }
+        }
+        basic_interned_multi_string(std::initializer_list<string_view_type> init) : basic_interned_multi_string(init.begin(), init.end()) {}
+
+    /*`Interning`*/
+        /* Id of the string, adding it to the unique strings if it is new. */
+        id_type intern(string_view_type str) {
+            return priv.intern(str);
+        }
+        /* Id of the string, or npos if it was never interned. */
+        id_type lookup(string_view_type str) const {
+            const slot &s = priv.table[priv.probe(str, priv.hash(str))];
+            return s.id;
+        }
+        string_view_type string(id_type id) const {
+            return priv.strings[id];
+        }
+        const multi_string_type &unique() const {
+            return priv.strings;
+        }
+        size_type unique_size() const {
+            return priv.strings.size();
+        }
+
+    /*`Element Access`*/
+        string_view_type at(size_type pos) const {
+            if (pos >= priv.ids.size()) {
+                throw std::out_of_range("Index out of bounds.");
+            }
+            return (*this)[pos];
+        }
+        string_view_type operator[](size_type pos) const {
+            return priv.strings[priv.ids[pos]];
+        }
+        string_view_type front() const {
+            return (*this)[0];
+        }
+        string_view_type back() const {
+            return (*this)[priv.ids.size() - 1];
+        }
+        id_type id(size_type pos) const {
+            return priv.ids[pos];
+        }
+        const std::vector<id_type> &ids() const {
+            return priv.ids;
+        }
+
+    /*`Iterators`*/
+        const_iterator begin() const {
+            return const_iterator(*this, priv.ids.data());
+        }
+        const_iterator end() const {
+            return const_iterator(*this, priv.ids.data() + priv.ids.size());
+        }
+
+    /*`Capacity`*/
+        bool empty() const {
+            return priv.ids.empty();
+        }
+        size_type size() const {
+            return priv.ids.size();
+        }
+        void reserve(size_type new_cap) {
+            priv.ids.reserve(new_cap);
+        }
+
+    /*`Modifiers`*/
+        /* Removes the entries, the unique strings and their ids stay. */
+        void clear() {
+            priv.ids.clear();
+        }
+        id_type push_back(string_view_type str) {
+            id_type id = priv.intern(str);
+            priv.ids.push_back(id);
+            return id;
+        }
+        const_iterator insert(const_iterator pos, string_view_type str) {
+            size_type position = pos - begin();
+            priv.ids.insert(priv.ids.begin() + position, priv.intern(str));
+            return begin() + position;
+        }
+        const_iterator erase(const_iterator pos) {
+            size_type position = pos - begin();
+            priv.ids.erase(priv.ids.begin() + position);
+            return begin() + position;
+        }
+        void pop_back() {
+            priv.ids.pop_back();
+        }
+        void swap(basic_interned_multi_string &other) {
+            std::swap(priv, other.priv);
+        }
+};
+
+using interned_multi_string = basic_interned_multi_string<char>;
+using winterned_multi_string = basic_interned_multi_string<wchar_t>;
+using u8interned_multi_string = basic_interned_multi_string<char8_t>;
+using u16interned_multi_string = basic_interned_multi_string<char16_t>;
+using u32interned_multi_string = basic_interned_multi_string<char32_t>;
+
+};
+#endif
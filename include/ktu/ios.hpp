@@ -1,18 +1,53 @@
 #pragma once
 #include <iomanip>
 #include <fstream>
+#include <charconv>
+#include <bit>
+#include <type_traits>
 #include <ktu/unicode.hpp>
 
 namespace ktu {
     struct io {
+        /* The bits of a value as an unsigned long, zero extended.
+            Floating point values keep their representation.
+        */
+        template <typename T>
+        static inline unsigned long unsignedBits(T value) {
+            if constexpr (std::floating_point<T>)
+                return std::bit_cast<typename ktu::to_unsigned_integral<sizeof(T)>::type>(value);
+            else
+                return static_cast<unsigned long>(static_cast<std::make_unsigned_t<T>>(value));
+        }
+
+        /* Render a value in binary into [first, last) without leading zeros.
+            Returns the end of the text, or last and std::errc::value_too_large if it does not fit.
+        */
+        static std::to_chars_result bits(char *first, char *last, unsigned long value);
+
+        /* Render a value in binary into [first, last) without leading zeros. */
+        template <typename T>
+        requires ((std::integral<T> || std::floating_point<T>) && !std::is_same<T,unsigned long>::value && !std::is_same<T,bool>::value && sizeof(T) <= sizeof(unsigned long))
+        static inline std::to_chars_result bits(char *first, char *last, T value) {
+            return bits(first, last, unsignedBits(value));
+        }
+
+        /* Render a value in octal into [first, last) without leading zeros. */
+        static std::to_chars_result octal(char *first, char *last, unsigned long value);
+
+        /* Render a value in decimal into [first, last). */
+        static std::to_chars_result decimal(char *first, char *last, unsigned long value);
+
+        /* Render a value in hexadecimal into [first, last) without leading zeros. */
+        static std::to_chars_result hexadecimal(char *first, char *last, unsigned long value, bool uppercase = false);
+
         /* Output a value in binary to an ostream. */
         static std::ostream &bits(std::ostream &os, unsigned long value);
 
         /* Output a value in binary to an ostream. */
         template <typename T>
-        requires ((std::integral<T> || std::floating_point<T>) && !std::is_same<T,unsigned long>::value)
+        requires ((std::integral<T> || std::floating_point<T>) && !std::is_same<T,unsigned long>::value && !std::is_same<T,bool>::value && sizeof(T) <= sizeof(unsigned long))
         static inline std::ostream &bits(std::ostream &os, T value) {
-            return bits(os, *(typename ktu::to_unsigned_integral<sizeof(T)>::type*)&value);
+            return bits(os, unsignedBits(value));
         }
 
         /* Output a value in octal to an ostream. */
@@ -32,6 +67,7 @@ namespace ktu {
         public:
             static int const manipGroupingId;
             static int const manipFlagId;
+            static int const manipThreadsId;
             struct fmtflags {
                 enum {
                     basefield =         0b0'00000000000000000000000'0'0'0'000'11,
@@ -206,6 +242,20 @@ namespace ktu {
                     }
             };
 
+            /* Set the amount of threads formatted output of large buffers is rendered with.
+                One by default, the output is identical for any amount.
+            */
+            class setthreads {
+                private:
+                    unsigned long threads;
+                public:
+                    setthreads(unsigned long threads) : threads(threads) {}
+                    friend std::ostream &operator<<(std::ostream& os, const setthreads &obj) {
+                        os.iword(manipThreadsId) = obj.threads;
+                        return os;
+                    }
+            };
+
             /* Output a buffer to an ostream.
             */
             class output {
@@ -217,6 +267,22 @@ namespace ktu {
                     friend std::ostream &operator<<(std::ostream& os, const output &obj);
             };
 
+            /* Write a canonical dump of a buffer in the layout of hexdump -C.
+                Every row holds the offset, 16 bytes in hexadecimal and the same bytes as ascii.
+                Rows identical to the one before are collapsed into a single '*' line.
+            */
+            static void dump(std::ostream &os, const void *ptr, size_t size);
+            /* Writes the dump straight to a file descriptor, bypassing iostreams.
+                Returns false if a write fails.
+            */
+            static bool dump(int fd, const void *ptr, size_t size);
+
+            /* Render a buffer the way an ostream with the given flags and grouping would output it,
+                without a stream. Every finished block of text is passed to write along with context.
+            */
+            static void render(const void *ptr, size_t size, long flags, unsigned long grouping,
+                void (*write)(void *context, const char *ptr, size_t size), void *context);
+
 
 
             
@@ -0,0 +1,112 @@
+#pragma once
+#include <ktu/memory/view.hpp>
+#include <ktu/memory/reader.hpp>
+#include <ktu/simd.hpp>
+#include <string>
+
+namespace ktu {
+    namespace json {
+
+        enum class token_type : uint8_t {
+            object_begin,
+            object_end,
+            array_begin,
+            array_end,
+            key,
+            string,
+            number,
+            boolean,
+            null,
+            end,
+            error
+        };
+
+        struct token {
+            token_type type = token_type::end;
+            /* Key and string contents without the quotes, or the text of a number or literal.
+                Points into the scanned input.
+            */
+            view data;
+            /* The key or string contains escape sequences, data must be passed through unescape to get its value. */
+            bool escaped = false;
+
+            inline std::string_view string_view() const {return std::string_view(data.begin<char>(), data.size());}
+            inline bool boolean() const {return type == token_type::boolean && *data.begin() == 't';}
+        };
+
+        /* Decodes the escape sequences of a key or string into out, which must have room for data.size() bytes.
+            Returns the end of the written contents, or nullptr if an escape sequence is invalid.
+        */
+        char *unescape(const view &data, char *out);
+        /* Returns the decoded value of a key or string, an invalid escape sequence results in an empty string. */
+        std::string unescape(const view &data);
+        inline std::string unescape(const token &t) {
+            return (t.escaped) ? unescape(t.data) : std::string(t.string_view());
+        }
+
+        /* Pulls tokens out of JSON text without copying or allocating.
+            Whitespace runs and string contents are skipped 64 bytes at a time,
+                nesting is tracked on a fixed size bit stack so depth is limited to max_depth.
+            Several top level values may follow each other, as in newline delimited JSON.
+            Escape sequences are only checked once a string is passed through unescape.
+        */
+        class scanner {
+            public:
+                static constexpr size_t max_depth = 1024;
+
+                scanner(const view &input) : first(input.begin()), last(input.end()), ptr(input.begin()) {}
+                /* Scans the unread part of the reader. */
+                scanner(reader &input) : scanner(view(input.cur(), input.end())) {}
+
+                /* Advances to the next token, returns false at the end of the input or on malformed input. */
+                bool next();
+
+                /* The token found by the last call to next. */
+                inline const token &get() const {return current;}
+
+                inline bool failed() const {return current.type == token_type::error;}
+
+                /* Number of objects and arrays that are currently open. */
+                inline size_t depth() const {return level;}
+
+                /* Position scanning will resume from. */
+                inline const uint8_t *position() const {return ptr;}
+
+            private:
+                enum class state : uint8_t {
+                    top,
+                    value,
+                    first_value,
+                    first_key,
+                    key,
+                    colon,
+                    comma
+                };
+
+                inline bool in_object() const {
+                    return (stack[(level - 1) / 64] >> ((level - 1) % 64)) & 1;
+                }
+                bool open(bool object);
+                bool close(bool object);
+                bool value();
+                bool string(token_type type);
+                bool number();
+                bool literal(const char *text, size_t size, token_type type);
+                bool fail();
+                inline void emit(token_type type, const uint8_t *begin, const uint8_t *end, bool escaped = false) {
+                    current.type = type;
+                    current.data = view(begin, end);
+                    current.escaped = escaped;
+                }
+
+                const uint8_t *first;
+                const uint8_t *last;
+                const uint8_t *ptr;
+                state expect = state::top;
+                size_t level = 0;
+                uint64_t stack[max_depth / 64] = {};
+                token current;
+        };
+
+    };
+};
@@ -2,6 +2,8 @@
 #include <ktu/memory/buffer.hpp>
 #include <ktu/memory/reader.hpp>
 #include <ktu/memory/file.hpp>
+#include <ktu/memory/encoding.hpp>
+#include <ktu/memory/format.hpp>
 
 
 
@@ -3,6 +3,7 @@
 #include <ktu/iterator.hpp>
 #include <ktu/ios.hpp>
 #include <ktu/bit.hpp>
+#include <ktu/charclass.hpp>
 
 
 
@@ -12,24 +13,6 @@ namespace ktu {
     class reader;
     class view;
 
-    constexpr unsigned long readBin(const char *&ptr, long size = -1);
-    constexpr bool isBin(const char c);
-
-    constexpr unsigned long readOct(const char *&ptr, long size = -1);
-    constexpr bool isOct(const char c);
-
-
-    constexpr unsigned long readDec(const char *&ptr, long size = -1);
-    constexpr bool isDec(const char c);
-
-    constexpr unsigned long readHex(const char *&ptr, long size = -1);
-    constexpr bool isHex(const char c);
-
-
-
-    const char *readVariable(const char *ptr);
-    constexpr bool isVariableStart(const char c);
-
     class buffer {
         public:
             using value_type = uint8_t;
@@ -496,6 +479,15 @@ namespace ktu {
                 priv.size = newSize;
             }
 
+            /* Grows the buffer by count elements left uninitialized, returns a pointer to the first of them. */
+            template <typename T = value_type>
+            inline T *grow(size_type count) {
+                size_type index = priv.size, newSize = index + count * sizeof(T);
+                reserve(newSize);
+                priv.size = newSize;
+                return (T*)(priv.data + index);
+            }
+
 
             void swap(buffer &other) noexcept;
 
@@ -503,6 +495,10 @@ namespace ktu {
             inline bool pushf(const std::filesystem::path &path) {
                 return insertf(size(), path);
             }
+            /* Appends everything left to read from the file descriptor, reading directly into the end of the buffer.
+                Returns false if a read fails, the bytes read before the failure are kept.
+            */
+            bool pushf(int fd);
             bool insertf(size_type index, const std::filesystem::path &path) {
                 return ktu::file::read(*this, index, path);
             }
@@ -526,6 +522,60 @@ namespace ktu {
             friend inline std::ostream &operator<<(std::ostream &os, const buffer &buf) {
                 return os << buf_io::output((const void*)buf.data(), buf.size());
             }
+            /* Resumable parser for the bracketed text format read by input.
+                The input may be split anywhere across calls to feed, decoded bytes are appended to the buffer passed in.
+            */
+            class decoder {
+                public:
+                    decoder(long flags = 0);
+
+                    /* Decodes the next part of the input and appends the result to buf. */
+                    void feed(buffer &buf, const char *ptr, size_t size);
+                    /* Ends the input, completing a number, utf-8 sequence or escape left open by the last feed. */
+                    void finish(buffer &buf);
+                    /* Returns how many bytes feed would append for this input without changing the state,
+                        including those appended by finish when final is set.
+                    */
+                    size_t measure(const char *ptr, size_t size, bool final = false) const;
+
+                private:
+                    friend buffer;
+
+                    template <class Sink> void run(Sink &sink, const uint8_t *ptr, const uint8_t *eos);
+                    template <class Sink> void flush(Sink &sink);
+                    template <class Sink> const uint8_t *numbers(Sink &sink, const uint8_t *ptr, const uint8_t *eos);
+                    template <class Sink> const uint8_t *text(Sink &sink, const uint8_t *ptr, const uint8_t *eos);
+                    template <class Sink> const uint8_t *bracket(Sink &sink, const uint8_t *ptr, const uint8_t *eos);
+                    template <class Sink> void unit(Sink &sink, uint32_t codepoint);
+                    template <class Sink> void codepoint(Sink &sink, uint32_t codepoint);
+                    const uint8_t *directive(const uint8_t *ptr, const uint8_t *eos);
+                    bool utf8(uint8_t c, uint32_t &codepoint);
+                    void apply(size_t hash);
+                    void setBase(uint8_t base);
+                    void setEncoding(uint8_t encoding);
+
+                    enum : uint8_t {
+                        top,
+                        section,
+                        expression
+                    } state = top;
+                    /* Encoding field of the flags, shifted down. */
+                    uint8_t encoding;
+                    uint8_t base;
+                    uint8_t digits;
+                    size_t (*write)(uint32_t, void*) = nullptr;
+                    int factor = 0;
+
+                    unsigned long number = 0;
+                    uint8_t numberSize = 0;
+                    bool identifier = false;
+                    size_t hash = 0;
+                    bool escape = false;
+                    uint8_t sequence[4];
+                    uint8_t sequenceSize = 0;
+                    uint8_t sequenceLength = 0;
+            };
+
             void input(const char *str, size_t size, long flags = 0);
             inline void input(const std::string &str, long flags = 0) {
                 return input(str.data(), str.size(), flags);
@@ -533,6 +583,13 @@ namespace ktu {
             inline void input(const std::u8string &str, long flags = 0) {
                 return input((const char*)str.data(), str.size(), flags);
             }
+            /* Decodes formatted input read from the file descriptor until its end.
+                Returns false if a read fails, the input decoded before the failure is kept.
+            */
+            bool input(int fd, long flags = 0);
+
+            /* Streams and file descriptors are read this many bytes at a time. */
+            static constexpr size_type block_size = 64 * 1024;
             
             friend std::istream &operator>>(std::istream &is, buffer &buf);
             
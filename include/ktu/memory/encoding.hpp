@@ -0,0 +1,32 @@
+#pragma once
+#include <ktu/memory/buffer.hpp>
+#include <ktu/memory/view.hpp>
+
+namespace ktu {
+
+    /* Number of characters encode_hex appends for size bytes. */
+    inline constexpr size_t encoded_hex_size(size_t size) {return size * 2;}
+
+    /* Number of characters encode_base64 appends for size bytes, including padding. */
+    inline constexpr size_t encoded_base64_size(size_t size) {return (size + 2) / 3 * 4;}
+
+    /* Appends two hexadecimal digits for every byte of the input to out.
+        Converts 32 bytes at a time with AVX2 or 16 with SSSE3.
+    */
+    void encode_hex(view input, buffer &out, bool uppercase = false);
+
+    /* Appends the bytes described by pairs of hexadecimal digits of either case to out.
+        Returns false and leaves out unchanged if the input has an odd length or a character that is not a digit.
+    */
+    bool decode_hex(view input, buffer &out);
+
+    /* Appends the standard base64 encoding of the input to out, padded with '='. */
+    void encode_base64(view input, buffer &out);
+
+    /* Appends the bytes described by standard base64 text to out, the trailing padding is optional.
+        Returns false and leaves out unchanged if the input has a character outside the alphabet,
+            padding anywhere but the end, or a length that cannot be produced by encode_base64.
+    */
+    bool decode_base64(view input, buffer &out);
+
+};
@@ -3,6 +3,8 @@
 #include <ktu/template.hpp>
 #include <fstream>
 #include <iostream>
+#include <initializer_list>
+#include <utility>
 
 
 
@@ -46,6 +48,36 @@ namespace ktu {
 
 
         static void read(const std::filesystem::path &path, void *dst, size_t filesize);
+
+        /* Replaces the file with the parts one after another, gathered by writev instead of copied into one buffer.
+            Returns false if the file could not be written.
+        */
+        static bool write(const std::filesystem::path &path, std::initializer_list<std::pair<const void*, size_t>> parts);
+
+        /* A read-only mapping of a whole file, unmapped on destruction. Empty if the file could not be mapped. */
+        class mapping {
+            public:
+                mapping() {}
+                mapping(const std::filesystem::path &path);
+                mapping(const mapping &) = delete;
+                mapping(mapping &&other) noexcept {swap(other);}
+                mapping &operator=(const mapping &) = delete;
+                mapping &operator=(mapping &&other) noexcept {
+                    swap(other);
+                    return *this;
+                }
+                ~mapping();
+
+                inline const void *data() const {return priv.data;}
+                inline size_t size() const {return priv.size;}
+                inline explicit operator bool() const {return priv.data;}
+                inline void swap(mapping &other) noexcept {std::swap(priv, other.priv);}
+            private:
+                struct priv_t {
+                    void *data = nullptr;
+                    size_t size = 0;
+                } priv;
+        };
         
         class info {
             public:
@@ -0,0 +1,176 @@
+#pragma once
+#include <ktu/memory/buffer.hpp>
+#include <ktu/memory/reader.hpp>
+#if __has_include(<format>)
+#include <format>
+#endif
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace ktu {
+    /* Format spec of buffers, views and readers, the same mini-language std::format strings use for them.
+            [[fill]align][width][base][encoding][-][#][.grouping]
+        fill        character to pad with, a space by default.
+        align       < left (default), > right, ^ center.
+        width       minimum amount of characters of the output, counted in bytes of the text.
+        base        x hexadecimal, d decimal, o octal, b binary.
+        encoding    n numeric, a ascii, l latin-1, u8, u16le, u16be, u32le, u32be.
+        -           no leading zeros.
+        #           begin with the format info.
+        grouping    amount of numerically represented bytes to place between spaces.
+        A spec without base, encoding, -, # or grouping outputs the raw bytes, any of them outputs formatted text
+            with the same defaults as buf_io::fmt.
+    */
+    struct buffer_format {
+        long flags = buf_io::fmtflags::nofmt;
+        unsigned long grouping = 0;
+        size_t width = 0;
+        char fill = ' ';
+        char align = '<';
+
+        /* Parses the spec and returns where it stopped, at last or the closing brace unless the spec is malformed. */
+        template <class Iterator>
+        constexpr Iterator parse(Iterator first, Iterator last) {
+            using fmtflags = buf_io::fmtflags;
+            auto match = [&](const char *text) {
+                Iterator it = first;
+                for (; *text; text++, it++)
+                    if (it == last || *it != *text) return false;
+                first = it;
+                return true;
+            };
+            auto alignment = [](char c) {return c == '<' || c == '>' || c == '^';};
+            auto number = [&](auto &value) {
+                for (; first != last && *first >= '0' && *first <= '9'; first++)
+                    value = value * 10 + (*first - '0');
+            };
+            if (first == last || *first == '}') return first;
+            Iterator second = first;
+            if (++second != last && alignment(*second) && *first != '{' && *first != '}') {
+                fill = *first;
+                align = *second;
+                first = ++second;
+            } else if (alignment(*first)) {
+                align = *first++;
+            }
+            number(width);
+            Iterator fields = first;
+            long formatted = fmtflags::fmt;
+            switch (first == last ? 0 : *first) {
+                case 'x': formatted |= fmtflags::hex; first++; break;
+                case 'd': formatted |= fmtflags::dec; first++; break;
+                case 'o': formatted |= fmtflags::oct; first++; break;
+                case 'b': formatted |= fmtflags::bin; first++; break;
+            }
+            if (match("n")) formatted |= fmtflags::numeric;
+            else if (match("a")) formatted |= fmtflags::ascii;
+            else if (match("l")) formatted |= fmtflags::latin_1;
+            else if (match("u8")) formatted |= fmtflags::utf_8;
+            else if (match("u16le")) formatted |= fmtflags::utf_16le;
+            else if (match("u16be")) formatted |= fmtflags::utf_16be;
+            else if (match("u32le")) formatted |= fmtflags::utf_32le;
+            else if (match("u32be")) formatted |= fmtflags::utf_32be;
+            if (match("-")) formatted |= fmtflags::nozfill;
+            if (match("#")) formatted |= fmtflags::fmtinfo;
+            Iterator dot = first;
+            if (match(".")) {
+                Iterator digits = first;
+                number(grouping);
+                // A grouping needs at least one digit.
+                if (first == digits) return dot;
+            }
+            if (first != fields)
+                flags = formatted;
+            return first;
+        }
+
+        /* Renders the bytes into an output iterator and returns its end. */
+        template <class OutputIt>
+        OutputIt format(const void *ptr, size_t size, OutputIt out) const {
+            auto write = [](void *context, const char *ptr, size_t size) {
+                OutputIt &out = *(OutputIt*)context;
+                out = std::copy(ptr, ptr + size, out);
+            };
+            if (!width) {
+                buf_io::render(ptr, size, flags, grouping, write, &out);
+                return out;
+            }
+            // The padding depends on the length of the text, so it is rendered first.
+            std::string text;
+            buf_io::render(ptr, size, flags, grouping, [](void *context, const char *ptr, size_t size) {
+                ((std::string*)context)->append(ptr, size);
+            }, &text);
+            size_t padding = (width > text.size()) ? width - text.size() : 0;
+            size_t before = (align == '>') ? padding : (align == '^') ? padding / 2 : 0;
+            out = std::fill_n(out, before, fill);
+            out = std::copy(text.begin(), text.end(), out);
+            return std::fill_n(out, padding - before, fill);
+        }
+    };
+
+    /* Renders a buffer, view or reader into an output iterator with a format spec, see buffer_format.
+        Throws std::invalid_argument if the spec is malformed.
+    */
+    template <class OutputIt>
+    OutputIt format_to(OutputIt out, std::string_view spec, const void *ptr, size_t size) {
+        buffer_format format;
+        if (format.parse(spec.begin(), spec.end()) != spec.end())
+            throw std::invalid_argument("Invalid buffer format spec.");
+        return format.format(ptr, size, out);
+    }
+    template <class OutputIt>
+    OutputIt format_to(OutputIt out, std::string_view spec, const view &v) {
+        return format_to(out, spec, v.begin(), v.size());
+    }
+    template <class OutputIt>
+    OutputIt format_to(OutputIt out, std::string_view spec, const reader &r) {
+        return format_to(out, spec, r.begin(), r.size());
+    }
+    template <class OutputIt>
+    OutputIt format_to(OutputIt out, std::string_view spec, const buffer &buf) {
+        return format_to(out, spec, buf.data(), buf.size());
+    }
+};
+
+#if defined(__cpp_lib_format)
+namespace ktu {
+    namespace impl {
+        /* Parsing shared by the formatters of buffers, views and readers. */
+        struct buffer_formatter {
+            buffer_format spec;
+            constexpr auto parse(std::format_parse_context &ctx) {
+                auto it = spec.parse(ctx.begin(), ctx.end());
+                if (it != ctx.end() && *it != '}')
+                    throw std::format_error("invalid format spec for a ktu buffer");
+                return it;
+            }
+        };
+    };
+};
+
+template <>
+struct std::formatter<ktu::view, char> : ktu::impl::buffer_formatter {
+    template <class FormatContext>
+    auto format(const ktu::view &v, FormatContext &ctx) const {
+        return spec.format(v.begin(), v.size(), ctx.out());
+    }
+};
+
+template <>
+struct std::formatter<ktu::reader, char> : ktu::impl::buffer_formatter {
+    template <class FormatContext>
+    auto format(const ktu::reader &r, FormatContext &ctx) const {
+        return spec.format(r.begin(), r.size(), ctx.out());
+    }
+};
+
+template <>
+struct std::formatter<ktu::buffer, char> : ktu::impl::buffer_formatter {
+    template <class FormatContext>
+    auto format(const ktu::buffer &buf, FormatContext &ctx) const {
+        return spec.format(buf.data(), buf.size(), ctx.out());
+    }
+};
+#endif
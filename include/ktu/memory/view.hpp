@@ -10,6 +10,7 @@
 #include <experimental/algorithm>
 #include <experimental/functional>
 #include <ktu/array.hpp>
+#include <ktu/string.hpp>
 namespace ktu {
     class buffer;
     class reader;
@@ -145,5 +146,17 @@ namespace ktu {
             friend reader;
     };
 
+    /* Parses integers separated by a delimiter from a view, see parse_many for ranges of characters. */
+    template <std::integral T, class OutputIt>
+    inline parse_many_result<OutputIt> parse_many(const view &input, char delimiter, OutputIt out, int base = 0) {
+        return parse_many<T>(input.begin<char>(), input.end<char>(), delimiter, out, base);
+    }
+
+    /* Parses a floating point number from the beginning of a view, see parse_float for ranges of characters. */
+    template <std::floating_point T>
+    inline std::from_chars_result parse_float(const view &input, T &value) {
+        return parse_float(input.begin<char>(), input.end<char>(), value);
+    }
+
     
 };
\ No newline at end of file
@@ -1,14 +1,45 @@
 #ifndef KTU__MULTI_STRING_HPP
 #define KTU__MULTI_STRING_HPP
 #include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <concepts>
+#include <condition_variable>
+#include <mutex>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <vector>
+#include <ktu/algorithm.hpp>
 #include <ktu/memory/file.hpp>
+#include <ktu/simd.hpp>
 
 namespace ktu {
+/* Header of a multi_string file, written by basic_multi_string::write and mapped by basic_multi_string_view.
+    It is followed by count + 1 offsets of the substrings into the blob as uint64_t, the last one being the blob size,
+        and by the blob of the substrings in order. Integers are in native byte order.
+*/
+struct multi_string_file_header {
+    static constexpr char signature[8] = {'k', 't', 'u', 'm', 's', 't', 'r', '\0'};
+    static constexpr uint32_t current_version = 1;
+    char magic[8];
+    uint32_t version;
+    uint32_t char_size;
+    uint64_t count;
+    uint64_t blob_size;
+};
+
+/* U is the type of the node indices and sizes, and limits the size of the cumulative string.
+    The packed layout keeps only the index of each node and derives its size from the index of the next,
+        which requires the substrings to stay in node order, so it has no arena mode.
+*/
 template <
-    class CharT
+    class CharT,
+    std::unsigned_integral U = size_t,
+    bool packed = false
 > class basic_multi_string {
     public:
     using char_type = CharT;
@@ -19,18 +50,23 @@ template <
     using string_type_const_reverse_iterator = typename string_type::const_reverse_iterator;
     using size_type = size_t;
     using ssize_type = ssize_t;
+    using index_type = U;
     static constexpr size_type npos = string_type::npos;
     using string_view_type = std::basic_string_view<char_type>;
-    struct node_type {
-        size_type index;
-        size_type size;
+    struct sized_node_type {
+        index_type index;
+        index_type size;
     };
+    struct packed_node_type {
+        index_type index;
+    };
+    using node_type = std::conditional_t<packed, packed_node_type, sized_node_type>;
     class const_reverse_iterator;
     class const_iterator {
         public:
             using iterator_category = std::random_access_iterator_tag;
             using iterator_concept = std::random_access_iterator_tag;
-            const_iterator(const basic_multi_string &parent, node_type *data) : priv{.parent=parent,.data=data} {}
+            const_iterator(const basic_multi_string &parent, node_type *data) : priv{.data=data,.parent=parent} {}
             const_iterator &operator++() {
                 ++priv.data;
                 return *this;
@@ -69,8 +105,7 @@ template <
                 return const_iterator(obj.priv.parent, obj.priv.data - diff);
             }
             string_view_type operator*() {
-                return priv.data->index == basic_multi_string::npos ?
-                    "" : string_view_type{priv.parent.priv.string.c_str() + priv.data->index, priv.data->size};
+                return string_view_type{data(), size()};
             }
 
             bool operator==(const const_iterator &other) const {
@@ -87,13 +122,13 @@ template <
                 return const_reverse_iterator(priv.parent, priv.data);
             }
             const char_type *data() const {
-                return priv.parent.priv.string.data() + priv.data->index;
+                return priv.parent.priv.string.data() + index();
             }
             size_t index() const {
-                return priv.data->index;
+                return priv.parent.priv.index(priv.data - priv.parent.priv.nodes.data());
             }
             size_t size() const {
-                return priv.data->size;
+                return priv.parent.priv.size(priv.data - priv.parent.priv.nodes.data());
             }
 
         private:
@@ -105,33 +140,487 @@ template <
     };
     private:
     struct priv {
-        static void nodes_shift_add(basic_multi_string::const_iterator pos, size_type shift) {
-            pos.priv.data->size += shift;
-            ++pos;
-            while (pos != pos.priv.parent.end()) {
-                pos.priv.data->index += shift;
-                ++pos;
+        string_type string;
+        std::vector<node_type> nodes;
+        size_type buildingIndex = 0;
+        /* Characters no longer referenced by any node, in arena mode. */
+        size_type garbage = 0;
+        bool arena = false;
+        /* An empty node may have the building index as its index in arena mode.
+            The substring ending there is then relocated before it is edited, editing it in place could move the building index past it.
+        */
+        bool emptyAtBuilding = false;
+        /* Swiss table from the substrings to the lowest position of a node holding each of them.
+            Each slot has a control byte, the low 7 bits of the hash of its substring or empty or deleted,
+                and a group of control bytes is compared at once with simd::block16.
+            Edits of substrings leave it invalid until it is rebuilt, lookups then fall back to a linear search.
+        */
+        struct table_type {
+            static constexpr uint8_t empty = 0x80, deleted = 0xFE;
+            static constexpr size_type group_size = simd::block16::width;
+            std::vector<uint8_t> control;
+            std::vector<size_type> slots;
+            unsigned bits = 0;
+            /* Full and deleted slots. */
+            size_type used = 0;
+            bool enabled = false;
+            bool valid = false;
+        } table;
+
+        size_type index(size_type pos) const {
+            return nodes[pos].index;
+        }
+        size_type size(size_type pos) const {
+            if constexpr (packed)
+                return (pos + 1 < nodes.size() ? index(pos + 1) : buildingIndex) - index(pos);
+            else
+                return nodes[pos].size;
+        }
+        static void set_size(node_type &node, size_type size) {
+            if constexpr (!packed)
+                node.size = size;
+        }
+        static node_type make_node(size_type index, size_type size) {
+            node_type node;
+            node.index = index;
+            set_size(node, size);
+            return node;
+        }
+        /* Indices are absolute, so the whole string must fit index_type. */
+        static void check_bounds(size_type size) {
+            if constexpr (std::numeric_limits<index_type>::max() < std::numeric_limits<size_type>::max()) {
+                if (size > std::numeric_limits<index_type>::max())
+                    throw std::out_of_range("Size exceeds maximum bounds of multi_string.");
+            }
+        }
+        /* Index of the substring at pos, or of the building substring at the end. */
+        size_type insertion_index(size_type pos) const {
+            return pos == nodes.size() ? buildingIndex : index(pos);
+        }
+        /* The building substring must already begin after the node, the packed layout derives its size from it. */
+        void push(size_type index, size_type size) {
+            check_bounds(string.size());
+            nodes.push_back(make_node(index, size));
+            if (!size)
+                emptyAtBuilding = true;
+            if (table.valid)
+                table_insert(nodes.size() - 1);
+        }
+        /* Resizes the substring at pos by shift and moves the substrings after it,
+            in arena mode it was relocated before the building substring and nothing is after it.
+        */
+        void shift(const_iterator pos, ssize_type shift) {
+            size_type position = pos.priv.data - nodes.data();
+            check_bounds(string.size());
+            set_size(*pos.priv.data, size(position) + shift);
+            buildingIndex += shift;
+            if (!size(position))
+                emptyAtBuilding = true;
+            if (arena)
+                return;
+            for (size_type i = position + 1; i < nodes.size(); ++i)
+                nodes[i].index += shift;
+        }
+        /* In arena mode copies the substring at pos in front of the building substring, unless it already ends there and no empty node is at the building index,
+            so that editing it in place moves nothing but the building substring.
+            Iterators into the substring are moved along with it.
+        */
+        template <class ...Iterators>
+        void relocate(const_iterator pos, Iterators &...iterators) {
+            size_type position = pos.priv.data - nodes.data(), from = index(position), size = this->size(position);
+            table.valid = false;
+            if (packed || !arena || (from + size == buildingIndex && !emptyAtBuilding))
+                return;
+            [[maybe_unused]] size_type offsets[] = {size_type(iterators - string.cbegin()) - from..., 0};
+            if (garbage + size > (string.size() + size) / 2) {
+                compact();
+                from = index(position);
+            }
+            if (from + size != buildingIndex || emptyAtBuilding) {
+                string.insert(buildingIndex, string, from, size);
+                pos.priv.data->index = buildingIndex;
+                garbage += size;
+                from = buildingIndex;
+                buildingIndex += size;
+            }
+            // Every other node now begins at or before the substring.
+            emptyAtBuilding = !size;
+            size_type i = 0;
+            ((iterators = string.cbegin() + (from + offsets[i++])), ...);
+        }
+        /* Counts characters that were dropped in arena mode, and compacts once they are more than half the string. */
+        void discard(size_type size) {
+            garbage += size;
+            if (garbage > string.size() / 2)
+                compact();
+        }
+        /* Rewrites the string with the substrings in order of the nodes and without garbage. */
+        void compact() {
+            string_type compacted;
+            compacted.reserve(string.size() - garbage);
+            for (size_type i = 0; i < nodes.size(); ++i) {
+                size_type from = index(i), size = this->size(i);
+                nodes[i].index = compacted.size();
+                compacted.append(string, from, size);
+            }
+            size_type building = compacted.size();
+            compacted.append(string, buildingIndex);
+            string.swap(compacted);
+            buildingIndex = building;
+            garbage = 0;
+            emptyAtBuilding = true;
+        }
+        /* Inserts length characters before the substring at pos, or before the building substring in arena mode,
+            and count nodes at pos for the caller to fill.
+            Returns the index of the characters.
+        */
+        size_type open(size_type pos, size_type count, size_type length) {
+            size_type index = arena ? buildingIndex : insertion_index(pos);
+            check_bounds(string.size() + length);
+            table.valid = false;
+            string.insert(index, length, char_type());
+            if (!arena) {
+                for (auto it = nodes.begin() + pos; it != nodes.end(); ++it)
+                    it->index += length;
+            }
+            nodes.insert(nodes.begin() + pos, count, make_node(index, 0));
+            buildingIndex += length;
+            emptyAtBuilding = true;
+            return index;
+        }
+        /* Calls f with the offset of every delimiter in [first, first + size) in order,
+            single byte characters are compared a block of simd::width at a time.
+        */
+        template <class F>
+        static void scan(const char_type *first, size_type size, char_type delimiter, F &&f) {
+            if constexpr (sizeof(char_type) == 1) {
+                for (size_type offset = 0; offset < size; offset += simd::width) {
+                    size_type remaining = size - offset;
+                    simd::block b = (remaining >= simd::width) ? simd::block(first + offset) : simd::block::partial(first + offset, remaining);
+                    uint64_t mask = b.eq((uint8_t)delimiter) & simd::low_bits(remaining);
+                    while (mask)
+                        f(offset + simd::pop_lowest(mask));
+                }
+            } else {
+                for (size_type i = 0; i < size; ++i) {
+                    if (first[i] == delimiter)
+                        f(i);
+                }
             }
         }
-        static void nodes_shift_subtract(const_iterator pos, size_type shift) {
-            pos.priv.data->size -= shift;
-            ++pos;
-            while (pos != pos.priv.parent.end()) {
-                pos.priv.data->index -= shift;
-                ++pos;
+        /* Turns the length characters at buildingIndex, inserted before the building substring, into nodes separated by delimiter.
+            With lines set a carriage return before a delimiter is dropped and a delimiter at the end does not begin another node.
+            The delimiters are squeezed out while scanning, in arena mode they become garbage instead and no characters move.
+            More than one thread scans separate parts of the characters at once, the nodes are then pushed in order.
+        */
+        void split(size_type length, char_type delimiter, bool lines, unsigned threads = 1) {
+            size_type first = buildingIndex, out = first, start = 0, dropped = 0;
+            auto field = [&](size_type end) {
+                size_type size = end - start;
+                if (lines && size && string[first + end - 1] == char_type('\r'))
+                    --size;
+                if (arena) {
+                    push(first + start, size);
+                } else {
+                    if (out != first + start)
+                        string_type::traits_type::move(string.data() + out, string.data() + first + start, size);
+                    buildingIndex = out + size;
+                    push(out, size);
+                    out += size;
+                }
+                dropped += end - start - size + 1;
+                start = end + 1;
+            };
+            if (threads > 1 && length >= threads * simd::width) {
+                std::vector<std::vector<size_type>> positions(threads);
+                std::vector<std::thread> workers;
+                size_type part = length / threads;
+                auto work = [&](unsigned i) {
+                    size_type from = i * part, size = (i + 1 == threads) ? length - from : part;
+                    scan(string.data() + first + from, size, delimiter, [&](size_type pos) {
+                        positions[i].push_back(from + pos);
+                    });
+                };
+                for (unsigned i = 1; i < threads; ++i)
+                    workers.emplace_back(work, i);
+                work(0);
+                for (auto &worker : workers)
+                    worker.join();
+                size_type count = nodes.size() + 1;
+                for (auto &found : positions)
+                    count += found.size();
+                nodes.reserve(count);
+                for (auto &found : positions) {
+                    for (size_type pos : found)
+                        field(pos);
+                }
+            } else {
+                scan(string.data() + first, length, delimiter, field);
+            }
+            if (start < length || !lines)
+                field(length);
+            else
+                ++dropped;
+            // The last field has no delimiter after it.
+            --dropped;
+            if (arena) {
+                buildingIndex = first + length;
+                discard(dropped);
+            } else {
+                string.erase(out, dropped);
+                buildingIndex = out;
             }
         }
-        static void nodes_shift_change(const_iterator pos, ssize_type shift) {
-            pos.priv.data->size += shift;
-            ++pos;
-            while (pos != pos.priv.parent.end()) {
-                pos.priv.data->index += shift;
-                ++pos;
+        struct sort_entry {
+            const char_type *data;
+            size_type size;
+        };
+        static bool sort_less(const sort_entry &lhs, const sort_entry &rhs, size_type depth) {
+            return string_view_type(lhs.data + depth, lhs.size - depth) < string_view_type(rhs.data + depth, rhs.size - depth);
+        }
+        /* Ranges shorter than this are sorted by comparison, and so are ranges this many characters deep,
+            which bounds the recursion.
+        */
+        static constexpr size_type radix_cutoff = 32;
+        static constexpr size_type radix_depth = 256;
+        /* Distributes the entries of [first, last), equal up to depth, by their character at depth into buffer and back,
+            skipping characters that all of them share. Buckets are counted in counts, the first one for the entries that end.
+            Returns the depth of the distribution, or npos if the range was sorted by comparison instead.
+        */
+        static size_type radix_distribute(sort_entry *first, sort_entry *last, sort_entry *buffer, size_type depth, size_type (&counts)[257]) {
+            for (;; ++depth) {
+                if (size_type(last - first) < radix_cutoff || depth >= radix_depth) {
+                    std::sort(first, last, [depth](const sort_entry &lhs, const sort_entry &rhs) {
+                        return sort_less(lhs, rhs, depth);
+                    });
+                    return npos;
+                }
+                std::fill(std::begin(counts), std::end(counts), 0);
+                for (sort_entry *it = first; it != last; ++it)
+                    ++counts[it->size > depth ? (uint8_t)it->data[depth] + 1 : 0];
+                if (counts[0] == size_type(last - first))
+                    return npos;
+                if (std::find(std::begin(counts) + 1, std::end(counts), size_type(last - first)) == std::end(counts))
+                    break;
+            }
+            size_type offsets[257];
+            for (size_type i = 0, offset = 0; i < 257; offset += counts[i++])
+                offsets[i] = offset;
+            for (sort_entry *it = first; it != last; ++it)
+                buffer[offsets[it->size > depth ? (uint8_t)it->data[depth] + 1 : 0]++] = *it;
+            std::copy(buffer, buffer + (last - first), first);
+            return depth;
+        }
+        /* MSD radix sort of single byte characters, the entries at first are the order of the buffer. */
+        static void radix_sort(sort_entry *first, sort_entry *last, sort_entry *buffer, size_type depth) {
+            size_type counts[257];
+            if ((depth = radix_distribute(first, last, buffer, depth, counts)) == npos)
+                return;
+            first += counts[0];
+            buffer += counts[0];
+            for (size_type i = 1; i < 257; ++i) {
+                if (counts[i] > 1)
+                    radix_sort(first, first + counts[i], buffer, depth + 1);
+                first += counts[i];
+                buffer += counts[i];
             }
         }
-        string_type string;
-        std::vector<node_type> nodes;
-        size_type buildingIndex = 0;
+        /* Sorts the entries with a pool of threads taking buckets off a shared stack,
+            buckets too small to be worth sharing are sorted by the thread that takes them.
+        */
+        static void parallel_sort(sort_entry *first, sort_entry *last, sort_entry *buffer, unsigned threads) {
+            struct task {
+                sort_entry *first, *last, *buffer;
+                size_type depth;
+            };
+            size_type shared = std::max<size_type>((last - first) / (threads * 16), 1 << 14);
+            std::vector<task> tasks{{first, last, buffer, 0}};
+            size_type pending = 1;
+            std::mutex mutex;
+            std::condition_variable ready;
+            auto work = [&]() {
+                std::unique_lock lock(mutex);
+                while (true) {
+                    ready.wait(lock, [&]() {return !tasks.empty() || !pending;});
+                    if (tasks.empty())
+                        return;
+                    task t = tasks.back();
+                    tasks.pop_back();
+                    lock.unlock();
+                    std::vector<task> children;
+                    if (size_type(t.last - t.first) < shared) {
+                        radix_sort(t.first, t.last, t.buffer, t.depth);
+                    } else {
+                        size_type counts[257];
+                        size_type depth = radix_distribute(t.first, t.last, t.buffer, t.depth, counts);
+                        if (depth != npos) {
+                            size_type offset = counts[0];
+                            for (size_type i = 1; i < 257; offset += counts[i++]) {
+                                if (counts[i] > 1)
+                                    children.push_back({t.first + offset, t.first + offset + counts[i], t.buffer + offset, depth + 1});
+                            }
+                        }
+                    }
+                    lock.lock();
+                    tasks.insert(tasks.end(), children.begin(), children.end());
+                    pending += children.size();
+                    --pending;
+                    ready.notify_all();
+                }
+            };
+            std::vector<std::thread> workers;
+            for (unsigned i = 1; i < threads; ++i)
+                workers.emplace_back(work);
+            work();
+            for (auto &worker : workers)
+                worker.join();
+        }
+        /* Orders the nodes by their substrings, wider characters are sorted by comparison.
+            In arena mode only the nodes are permuted,
+            otherwise the substrings are gathered in their new order to keep the cumulative string in node order.
+        */
+        void sort(unsigned threads) {
+            std::vector<sort_entry> entries(nodes.size());
+            for (size_type i = 0; i < nodes.size(); ++i)
+                entries[i] = {string.data() + index(i), size(i)};
+            if constexpr (sizeof(char_type) == 1) {
+                std::vector<sort_entry> buffer(entries.size());
+                if (threads > 1)
+                    parallel_sort(entries.data(), entries.data() + entries.size(), buffer.data(), threads);
+                else
+                    radix_sort(entries.data(), entries.data() + entries.size(), buffer.data(), 0);
+            } else {
+                std::sort(entries.begin(), entries.end(), [](const sort_entry &lhs, const sort_entry &rhs) {return sort_less(lhs, rhs, 0);});
+            }
+            if (arena) {
+                for (size_type i = 0; i < nodes.size(); ++i)
+                    nodes[i] = make_node(entries[i].data - string.data(), entries[i].size);
+            } else {
+                string_type gathered;
+                gathered.reserve(string.size());
+                for (size_type i = 0; i < nodes.size(); ++i) {
+                    nodes[i] = make_node(gathered.size(), entries[i].size);
+                    gathered.append(entries[i].data, entries[i].size);
+                }
+                size_type building = gathered.size();
+                gathered.append(string, buildingIndex);
+                string.swap(gathered);
+                buildingIndex = building;
+            }
+            if (table.enabled)
+                table_build();
+        }
+        string_view_type view(size_type pos) const {
+            return string_view_type(string.data() + index(pos), size(pos));
+        }
+        static uint64_t table_hash(string_view_type str) {
+            return ktu::hash((const void*)str.data(), str.size() * sizeof(char_type));
+        }
+        /* First group of the probe, from the upper bits after a Fibonacci multiplication,
+            the last characters barely reach the top bits of FNV-1a.
+        */
+        size_type table_group(uint64_t hash) const {
+            return table.bits ? (hash * 0x9E3779B97F4A7C15ULL) >> (64 - table.bits) : 0;
+        }
+        /* Slot of the substring, or npos. */
+        size_type table_find(string_view_type str, uint64_t hash) const {
+            for (size_type group = table_group(hash), mask = (size_type(1) << table.bits) - 1;; group = (group + 1) & mask) {
+                simd::block16 control(table.control.data() + group * table_type::group_size);
+                for (uint64_t match = control.eq(hash & 0x7F); match;) {
+                    size_type slot = group * table_type::group_size + simd::pop_lowest(match);
+                    if (view(table.slots[slot]) == str)
+                        return slot;
+                }
+                if (control.eq(table_type::empty))
+                    return npos;
+            }
+        }
+        /* Adds the node at pos unless a node before it holds the same substring. */
+        void table_insert(size_type pos) {
+            if ((table.used + 1) * 8 > table.control.size() * 7) {
+                table_build();
+                return;
+            }
+            string_view_type str = view(pos);
+            uint64_t hash = table_hash(str);
+            if (table_find(str, hash) != npos)
+                return;
+            for (size_type group = table_group(hash), mask = (size_type(1) << table.bits) - 1;; group = (group + 1) & mask) {
+                simd::block16 control(table.control.data() + group * table_type::group_size);
+                if (uint64_t free = control.eq(table_type::empty) | control.eq(table_type::deleted)) {
+                    size_type slot = group * table_type::group_size + simd::pop_lowest(free);
+                    table.used += table.control[slot] == table_type::empty;
+                    table.control[slot] = hash & 0x7F;
+                    table.slots[slot] = pos;
+                    return;
+                }
+            }
+        }
+        /* Rebuilds the table for the nodes, with room to double before it grows again. */
+        void table_build() {
+            size_type groups = 1;
+            while (groups * table_type::group_size * 7 < nodes.size() * 16)
+                groups *= 2;
+            table.bits = std::countr_zero(groups);
+            table.control.assign(groups * table_type::group_size, table_type::empty);
+            table.slots.resize(table.control.size());
+            table.used = 0;
+            table.valid = true;
+            for (size_type pos = 0; pos < nodes.size(); ++pos)
+                table_insert(pos);
+        }
+        /* Removes the nodes in [first, last), before they are erased, and moves later positions back.
+            Returns true if a removed node was the lowest with its substring and later nodes remain,
+                they are then added again with table_fill once the nodes are erased.
+        */
+        bool table_erase(size_type first, size_type last) {
+            if (!table.valid)
+                return false;
+            bool owners = false;
+            for (size_type pos = first; pos < last; ++pos) {
+                string_view_type str = view(pos);
+                size_type slot = table_find(str, table_hash(str));
+                if (slot == npos || table.slots[slot] != pos)
+                    continue;
+                owners = true;
+                // A probe stops at a group with an empty slot, so the slot can become empty as well.
+                if (simd::block16(table.control.data() + slot / table_type::group_size * table_type::group_size).eq(table_type::empty)) {
+                    table.control[slot] = table_type::empty;
+                    --table.used;
+                } else {
+                    table.control[slot] = table_type::deleted;
+                }
+            }
+            if (last == nodes.size())
+                return false;
+            for (size_type slot = 0; slot < table.control.size(); ++slot) {
+                if (!(table.control[slot] & 0x80) && table.slots[slot] >= last)
+                    table.slots[slot] -= last - first;
+            }
+            return owners;
+        }
+        void table_fill(size_type first) {
+            for (size_type pos = first; pos < nodes.size(); ++pos)
+                table_insert(pos);
+        }
+        void clear() {
+            string.clear();
+            nodes.clear();
+            buildingIndex = 0;
+            garbage = 0;
+            emptyAtBuilding = false;
+            if (table.enabled)
+                table_build();
+        }
+        void swap(struct priv &other) {
+            string.swap(other.string);
+            nodes.swap(other.nodes);
+            std::swap(buildingIndex, other.buildingIndex);
+            std::swap(garbage, other.garbage);
+            std::swap(arena, other.arena);
+            std::swap(emptyAtBuilding, other.emptyAtBuilding);
+            std::swap(table, other.table);
+        }
     } priv;
 
     public:
@@ -262,23 +751,17 @@ template <
                     }
                 }
             }
-            basic_multi_string(const basic_multi_string &other) {
-                priv.string = other.priv.string;
-                priv.nodes = other.priv.nodes;
-            }
+            basic_multi_string(const basic_multi_string &other) : priv(other.priv) {}
             basic_multi_string(basic_multi_string &&other) noexcept {
-                priv.string.swap(other.priv.string);
-                priv.nodes.swap(other.priv.nodes);
+                priv.swap(other.priv);
             }
         /*`Operator=`*/
             basic_multi_string &operator=(const basic_multi_string &other) {
-                priv.string = other.priv.string;
-                priv.nodes = other.priv.nodes;
+                priv = other.priv;
                 return *this;
             }
             basic_multi_string &operator=(basic_multi_string &&other) {
-                priv.string.swap(other.priv.string);
-                priv.nodes.swap(other.priv.nodes);
+                priv.swap(other.priv);
                 return *this;
             }
             template <typename T>
@@ -419,16 +902,16 @@ template <
                 if (pos >= priv.nodes.size()) {
                     throw std::out_of_range("Index out of bounds.");
                 }
-                return string_view_type(priv.string.c_str() + priv.nodes[pos].index, priv.nodes[pos].size);
+                return (*this)[pos];
             }
             string_view_type operator[](size_type pos) const {
-                return string_view_type(priv.string.c_str() + priv.nodes[pos].index, priv.nodes[pos].size);
+                return string_view_type(priv.string.c_str() + priv.index(pos), priv.size(pos));
             }
             string_view_type front() const {
-                return string_view_type(priv.string.c_str() + priv.nodes.front().index, priv.nodes.front().size);
+                return (*this)[0];
             }
             string_view_type back() const {
-                return string_view_type(priv.string.c_str() + priv.nodes.back().index, priv.nodes.back().size);
+                return (*this)[priv.nodes.size() - 1];
             }
 
     /*`Iterators`*/
@@ -588,8 +1071,7 @@ template <
 
     /*`Standard Modifiers`*/
         void clear() {
-            priv.string.clear();
-            priv.nodes.clear();
+            priv.clear();
         }
         /*`insert`*/
             template <typename ...Types>
@@ -603,19 +1085,14 @@ template <
                 return insert(pos, string_view_type(s, length));
             }
             const_iterator insert(const_iterator pos, string_view_type value) {
-                size_type
-                    iteratorIndex = pos - begin(),
-                    insertedNodeStringIndex = pos.priv.data->index;
-                priv.string.insert(insertedNodeStringIndex, value);
-                while (pos != end()) {
-                    pos.priv.data->index += value.size();
-                    ++pos;
-                }
-                priv.nodes.insert(
-                    priv.nodes.begin() + iteratorIndex,
-                    node_type{ insertedNodeStringIndex, value.size()}
-                );
-
+                size_type iteratorIndex = pos - begin();
+                string_type aliased;
+                if (value.data() >= priv.string.data() && value.data() <= priv.string.data() + priv.string.size()) {
+                    value = aliased.assign(value);
+                }
+                size_type insertedNodeStringIndex = priv.open(iteratorIndex, 1, value.size());
+                string_type::traits_type::copy(priv.string.data() + insertedNodeStringIndex, value.data(), value.size());
+                priv.set_size(priv.nodes[iteratorIndex], value.size());
                 return begin() + iteratorIndex;
             }
             const_iterator insert(const_iterator pos, const string_type &value) {
@@ -627,22 +1104,25 @@ template <
                 return *this;
             }
             const_iterator insert(const_iterator pos, const_iterator first, const_iterator last) {
-                size_type
-                    insertionCount = last - first,
-                    iteratorIndex = pos - begin(),
-                    insertedNodesStringIndex = pos.priv.data->index;
-                string_view_type totalStringToInsert(first.priv.parent.priv.string.data() + first.priv.data->index, ((last-1).priv.data->index - first.priv.data->index) + (last-1).priv.data->size);
-                priv.string.insert(insertedNodesStringIndex, totalStringToInsert);
-                while (pos != end()) {
-                    pos.priv.data->index += totalStringToInsert.size();
-                    ++pos;
-                }
-                priv.nodes.insert(priv.nodes.begin() + iteratorIndex, insertionCount, {});
+                if (first == last)
+                    return pos;
+                size_type iteratorIndex = pos - begin();
+                // Gathered first, the range may be in this string or in arena order.
+                string_type totalStringToInsert;
+                std::vector<size_type> sizes;
+                sizes.reserve(last - first);
+                for (auto it = first; it != last; ++it) {
+                    totalStringToInsert.append(*it);
+                    sizes.push_back(it.size());
+                }
+                size_type insertedNodesStringIndex = priv.open(iteratorIndex, sizes.size(), totalStringToInsert.size());
+                totalStringToInsert.copy(priv.string.data() + insertedNodesStringIndex, totalStringToInsert.size());
                 auto nodeIterator = priv.nodes.begin() + iteratorIndex;
-                for (auto it = first; it != last; ++it, ++nodeIterator) {
+                for (size_type size : sizes) {
                     nodeIterator->index = insertedNodesStringIndex;
-                    nodeIterator->size = it.priv.data->size;
-                    insertedNodesStringIndex += it.priv.data->size;
+                    priv.set_size(*nodeIterator, size);
+                    insertedNodesStringIndex += size;
+                    ++nodeIterator;
                 }
                 return begin() + iteratorIndex;
             }
@@ -701,22 +1181,14 @@ template <
                     insertionCount = 0;
                 }
                 size_type totalInsertionSize = 0;
-                size_type newItemsIndex = pos.priv.data->index;
-                auto itemPos = priv.nodes.begin() + (pos.priv.data - priv.nodes.data());
                 
                 for (InputIt it = first; it != last; ++it) {
                     totalInsertionSize += iteratorSize(it);
                     if constexpr (!is_random_access) {++insertionCount;}
                 }
                 
-                priv.string.insert(newItemsIndex, totalInsertionSize, 0);
-                
-                while (pos != end()) {
-                    pos.priv.data->index += totalInsertionSize;
-                    ++pos;
-                }
-                
-                priv.nodes.insert(itemPos, insertionCount, {});
+                size_type newItemsIndex = priv.open(iteratorIndex, insertionCount, totalInsertionSize);
+                auto itemPos = priv.nodes.begin() + iteratorIndex;
                 char_type *insertPointer = priv.string.data() + newItemsIndex;
                 
                 for (InputIt it = first; it != last; ++it) {
@@ -725,7 +1197,7 @@ template <
                     
                     memcpy(insertPointer, src, n);
                     itemPos->index = insertPointer - priv.string.data();
-                    itemPos->size = n;
+                    priv.set_size(*itemPos, n);
                     insertPointer += n;
                     ++itemPos;
                 }
@@ -760,15 +1232,7 @@ template <
                 return erase(pos.base(), args...).reverse();
             }
             const_iterator erase(const_iterator pos) {
-                priv.string.erase(pos.priv.data->index, pos.priv.data->size);
-                size_type iteratorIndex = pos - begin();
-                auto nodePositionToErase = priv.nodes.begin() + iteratorIndex;
-                while (pos != end()) {
-                    pos.priv.data->index -= nodePositionToErase->size;
-                    ++pos;
-                }
-                priv.nodes.erase(nodePositionToErase);
-                return begin() + iteratorIndex;
+                return erase(pos, pos + 1);
             }
             
             basic_multi_string &erase(size_type pos, size_type count) {
@@ -779,23 +1243,37 @@ template <
                 return erase(first.base(), last.base()).reverse();
             }
             const_iterator erase(const_iterator first, const_iterator last) {
-                size_type erasureCount = (last-1).priv.data->index + (last-1).priv.data->size - first.priv.data->index;
-                priv.string.erase(first.priv.data->index, erasureCount);
-                size_type iteratorIndex = first - begin();
+                if (first == last)
+                    return first;
+                size_type iteratorIndex = first - begin(), erasureCount = 0;
+                bool refill = priv.table_erase(iteratorIndex, last - begin());
+                if (priv.arena) {
+                    for (auto it = first; it != last; ++it) {
+                        erasureCount += it.size();
+                    }
+                } else {
+                    erasureCount = (last-1).index() + (last-1).size() - first.index();
+                    priv.string.erase(first.index(), erasureCount);
+                }
                 auto nodesFirst = priv.nodes.begin() + iteratorIndex, nodesLast = nodesFirst + (last-first);
-                for (auto it = nodesLast; it != priv.nodes.end(); ++it) {
-                    it->index -= erasureCount;
+                if (!priv.arena) {
+                    for (auto it = nodesLast; it != priv.nodes.end(); ++it) {
+                        it->index -= erasureCount;
+                    }
+                    priv.buildingIndex -= erasureCount;
                 }
                 priv.nodes.erase(nodesFirst, nodesLast);
+                if (refill)
+                    priv.table_fill(iteratorIndex);
+                if (priv.arena)
+                    priv.discard(erasureCount);
                 return begin() + iteratorIndex;
             }
         /*`push_back`*/
             void push_building() {
-                priv.nodes.push_back({
-                    .index = priv.buildingIndex,
-                    .size = building_size()
-                });
+                size_type index = priv.buildingIndex;
                 priv.buildingIndex = priv.string.size();
+                priv.push(index, priv.buildingIndex - index);
             }
             void push_back(string_view_type str) {
                 priv.string.append(str);
@@ -835,9 +1313,17 @@ template <
                 push_building();
             }
         void pop_back() {
-            priv.buildingIndex = priv.nodes.back().index;
-            priv.string.resize(priv.buildingIndex);
+            priv.table_erase(priv.nodes.size() - 1, priv.nodes.size());
+            size_type index = priv.index(priv.nodes.size() - 1), size = priv.size(priv.nodes.size() - 1);
             priv.nodes.pop_back();
+            // In arena mode empty nodes may sit at the end of the last one, so its characters become garbage instead of being cut off.
+            if (priv.arena) {
+                priv.string.resize(priv.buildingIndex);
+                priv.discard(size);
+                return;
+            }
+            priv.buildingIndex = index;
+            priv.string.resize(priv.buildingIndex);
         }
         void resize(size_type sz) {
             auto order = sz <=> priv.nodes.size();
@@ -845,29 +1331,38 @@ template <
                 return;
             }
             if (order == std::strong_ordering::greater) {
-                priv.nodes.resize(sz, {.index = priv.buildingIndex, .size = 0});
-                priv.nodes[sz].index = priv.buildingIndex;
-                priv.nodes[sz].size = building_size();
-                priv.buildingIndex = priv.string.size();
+                priv.nodes.reserve(sz);
+                while (priv.nodes.size() + 1 < sz) {
+                    priv.push(priv.buildingIndex, 0);
+                }
+                push_building();
                 return;
             }
             
-            priv.buildingIndex = priv.nodes[sz].index;
+            priv.table_erase(sz, priv.nodes.size());
+            size_type discarded = 0;
+            if (priv.arena) {
+                for (size_type i = sz; i < priv.nodes.size(); ++i) {
+                    discarded += priv.size(i);
+                }
+            } else {
+                priv.buildingIndex = priv.index(sz);
+            }
             priv.nodes.resize(sz);
+            if (discarded)
+                priv.discard(discarded);
         }
         void resize(size_type sz, string_view_type str) {
-            priv.string.clear();
+            priv.clear();
             priv.string.reserve(str.size()*sz);
-            priv.nodes.clear();
             priv.nodes.reserve(sz);
             for (size_type i = 0; i < sz; ++i) {
                 push_back(str);
             }
         }
         void resize(size_type sz, const string_type &str) {
-            priv.string.clear();
+            priv.clear();
             priv.string.reserve(str.size()*sz);
-            priv.nodes.clear();
             priv.nodes.reserve(sz);
             for (size_type i = 0; i < sz; ++i) {
                 push_back(str);
@@ -881,9 +1376,8 @@ template <
             resize(sz, s, N);
         }
         void resize(size_type sz, const char_type *s, size_type len) {
-            priv.string.clear();
+            priv.clear();
             priv.string.reserve(len*sz);
-            priv.nodes.clear();
             priv.nodes.reserve(sz);
             for (size_type i = 0; i < sz; ++i) {
                 push_back(s, len);
@@ -891,26 +1385,23 @@ template <
         }
         template <class InputIt>
         void resize(size_type sz, InputIt first, InputIt last) {
-            priv.string.clear();
+            priv.clear();
             priv.string.reserve((std::distance(first, last))*sz);
-            priv.nodes.clear();
             priv.nodes.reserve(sz);
             for (size_type i = 0; i < sz; ++i) {
                 push_back(first,last);
             }
         }
         void resize(size_type sz, std::initializer_list<char_type> il) {
-            priv.string.clear();
+            priv.clear();
             priv.string.reserve(il.size()*sz);
-            priv.nodes.clear();
             priv.nodes.reserve(sz);
             for (size_type i = 0; i < sz; ++i) {
                 push_back(il);
             }
         }
         void swap(basic_multi_string &other) {
-            priv.string.swap(other.priv.string);
-            priv.nodes.swap(other.priv.nodes);
+            priv.swap(other.priv);
         }
 
     
@@ -929,9 +1420,16 @@ template <
                     substring_clear(pos.base());
                 }
                 void substring_clear(const_iterator pos) {
-                    size_t reduced_size = pos.priv.data->size;
-                    priv.string.erase(pos.priv.data->index, reduced_size);
-                    priv::nodes_shift_subtract(pos, reduced_size);
+                    size_t reduced_size = pos.size();
+                    priv.table.valid = false;
+                    if (priv.arena) {
+                        priv.set_size(*pos.priv.data, 0);
+                        priv.emptyAtBuilding = true;
+                        priv.discard(reduced_size);
+                        return;
+                    }
+                    priv.string.erase(pos.index(), reduced_size);
+                    priv.shift(pos, -reduced_size);
                 }
             /*`insert`*/
                 template <typename ...Types>
@@ -943,8 +1441,9 @@ template <
                     return substring_insert(pos.base(), args...);
                 }
                 basic_multi_string &substring_insert(const_iterator pos, size_type index, size_type count, char_type ch) {
-                    priv.string.insert(pos.priv.data->index + index, count, ch);
-                    priv::nodes_shift_add(pos, count);
+                    priv.relocate(pos);
+                    priv.string.insert(pos.index() + index, count, ch);
+                    priv.shift(pos, count);
                     return *this;
                 }
                 template <size_t N>
@@ -958,56 +1457,64 @@ template <
                     return substring_insert(pos, index, string_view_type(s, count));
                 }
                 basic_multi_string &substring_insert(const_iterator pos, size_type index, const string_type &str) {
-                    priv.string.insert(pos.priv.data->index + index, str);
-                    priv::nodes_shift_add(pos, str.size());
+                    priv.relocate(pos);
+                    priv.string.insert(pos.index() + index, str);
+                    priv.shift(pos, str.size());
                     return *this;
                 }
                 basic_multi_string &substring_insert(const_iterator pos, size_type index, const string_type &str, size_type s_index, size_type count = npos) {
-                    priv.string.insert(pos.priv.data->index + index, str, s_index, count);
+                    priv.relocate(pos);
+                    priv.string.insert(pos.index() + index, str, s_index, count);
                     size_t insertionSize = (count==npos) ? str.size()-s_index : count;
-                    priv::nodes_shift_add(pos, insertionSize);
+                    priv.shift(pos, insertionSize);
                     return *this;
                 }
                 string_type_iterator substring_insert(const_iterator pos, string_type_const_iterator s_pos, char_type ch) {
-                    size_t iteratorIndex = (pos.priv.data->index + s_pos) - priv.string.begin();
-                    priv.string.insert(pos.priv.data->index + s_pos, ch);
-                    priv::nodes_shift_add(pos, 1);
+                    priv.relocate(pos, s_pos);
+                    size_t iteratorIndex = s_pos - priv.string.begin();
+                    priv.string.insert(s_pos, ch);
+                    priv.shift(pos, 1);
                     return priv.string.begin() + iteratorIndex;
                 }
                 string_type_iterator substring_insert(const_iterator pos, string_type_const_iterator s_pos, size_type count, char_type ch) {
-                    size_t iteratorIndex = (pos.priv.data->index + s_pos) - priv.string.begin();
-                    priv.string.insert(pos.priv.data->index + s_pos, count, ch);
-                    priv::nodes_shift_add(pos, count);
+                    priv.relocate(pos, s_pos);
+                    size_t iteratorIndex = s_pos - priv.string.begin();
+                    priv.string.insert(s_pos, count, ch);
+                    priv.shift(pos, count);
                     return priv.string.begin() + iteratorIndex;
                 }
                 template <class InputIt>
                 string_type_iterator substring_insert(const_iterator pos, string_type_const_iterator s_pos, InputIt first, InputIt last) {
-                    size_t iteratorIndex = (pos.priv.data->index + s_pos) - priv.string.begin();
+                    priv.relocate(pos, s_pos);
+                    size_t iteratorIndex = s_pos - priv.string.begin();
                     size_t insertionSize = priv.string.size();
-                    priv.string.insert(pos.priv.data->index + s_pos, first, last);
+                    priv.string.insert(s_pos, first, last);
                     insertionSize = priv.string.size() - insertionSize;
-                    priv::nodes_shift_add(pos, insertionSize);
+                    priv.shift(pos, insertionSize);
                     return priv.string.begin() + iteratorIndex;
                 }
                 string_type_iterator substring_insert(const_iterator pos, string_type_const_iterator s_pos, std::initializer_list<char_type> ilist) {
-                    size_t iteratorIndex = (pos.priv.data->index + s_pos) - priv.string.begin();
-                    priv.string.insert(pos.priv.data->index + s_pos, ilist);
-                    priv::nodes_shift_add(pos, ilist.size());
+                    priv.relocate(pos, s_pos);
+                    size_t iteratorIndex = s_pos - priv.string.begin();
+                    priv.string.insert(s_pos, ilist);
+                    priv.shift(pos, ilist.size());
                     return priv.string.begin() + iteratorIndex;
                 }
                 template <class StringViewLike>
                 requires (std::is_convertible_v<StringViewLike, string_view_type> && !std::is_convertible_v<StringViewLike, const char_type*>)
                 basic_multi_string &substring_insert(const_iterator pos, size_type index, const StringViewLike& t) {
-                    priv.string.insert(pos.priv.data->index + index, t);
-                    priv::nodes_shift_add(pos, t.size());
+                    priv.relocate(pos);
+                    priv.string.insert(pos.index() + index, t);
+                    priv.shift(pos, t.size());
                     return *this;
                 }
                 template <class StringViewLike>
                 requires (std::is_convertible_v<StringViewLike, string_view_type> && !std::is_convertible_v<StringViewLike, const char_type*>)
                 basic_multi_string &substring_insert(const_iterator pos, size_type index, const StringViewLike& t, size_type t_index, size_type count = npos) {
+                    priv.relocate(pos);
                     size_t insertionSize = (count==npos) ? t.size()-t_index : count;
-                    priv.string.insert(pos.priv.data->index + index, t, t_index, npos);
-                    priv::nodes_shift_add(pos, insertionSize);
+                    priv.string.insert(pos.index() + index, t, t_index, npos);
+                    priv.shift(pos, insertionSize);
                     return *this;
                 }
             /*`erase`*/
@@ -1020,33 +1527,33 @@ template <
                     return substring_erase(pos.base(), args...);
                 }
                 basic_multi_string &substring_erase(const_iterator pos, size_type index = 0, size_type count = npos) {
-                    size_t erasureSize = (count == npos) ? pos.priv.data->size - index : count;
-                    priv.string.erase(pos.priv.data->index + index, erasureSize);
-                    priv::nodes_shift_subtract(pos, erasureSize);
+                    priv.relocate(pos);
+                    size_t erasureSize = (count == npos) ? pos.size() - index : count;
+                    priv.string.erase(pos.index() + index, erasureSize);
+                    priv.shift(pos, -erasureSize);
                     return *this;
                 }
                 string_type_iterator substring_erase(const_iterator pos, string_type_const_iterator s_position) {
-                    size_t
-                        iteratorIndex = s_position - priv.string.begin(),
-                        erasureSize = pos.priv.data->size - (iteratorIndex);
-                    priv.string.erase(pos.priv.data->index, erasureSize);
-                    priv::nodes_shift_subtract(pos, erasureSize);
+                    priv.relocate(pos, s_position);
+                    size_t iteratorIndex = s_position - priv.string.begin();
+                    priv.string.erase(s_position);
+                    priv.shift(pos, -1);
                     return priv.string.begin() + iteratorIndex;
                 }
                 string_type_iterator substring_erase(const_iterator pos, string_type_const_iterator first, string_type_const_iterator last) {
+                    priv.relocate(pos, first, last);
                     size_t
                         iteratorIndex = first - priv.string.begin(),
                         erasureSize = last - first;
                     priv.string.erase(first, last);
-                    priv::nodes_shift_subtract(pos, erasureSize);
+                    priv.shift(pos, -erasureSize);
                     return  priv.string.begin() + iteratorIndex;
                 }
             /*`push_back`*/
                 void substring_push_back(size_type pos, char_type ch) {substring_push_back(begin()+pos, ch);}    
                 void substring_push_back(const_reverse_iterator pos, char_type ch) {substring_push_back(pos.base(), ch);}
                 void substring_push_back(const_iterator pos, char_type ch) {
-                    priv.string.push_back(ch);
-                    substring_insert(pos, priv.string.begin()+pos.priv.data->size, ch);
+                    substring_insert(pos, pos.size(), 1, ch);
                 }
             /*`append`*/
                 template <typename ...Types>
@@ -1058,230 +1565,243 @@ template <
                     return substring_append(pos.base(), args...);
                 }
                 basic_multi_string &substring_append(const_iterator pos, size_type count, char_type ch) {
-                    return substring_insert(pos, pos.priv.data->size, count, ch);
+                    return substring_insert(pos, pos.size(), count, ch);
                 }
                 basic_multi_string &substring_append(const_iterator pos, const string_type &str) {
-                    return substring_insert(pos, pos.priv.data->size, str);
+                    return substring_insert(pos, pos.size(), str);
                 }
                 basic_multi_string &substring_append(const_iterator pos, const string_type &str, size_type subpos, size_type sublen = string_type::npos) {
-                    return substring_insert(pos, pos.priv.data->size, str, subpos, sublen);
+                    return substring_insert(pos, pos.size(), str, subpos, sublen);
                 }
                 basic_multi_string &substring_append(const_iterator pos, const char_type *s, size_type n) {
-                    return substring_insert(pos, pos.priv.data->size, s, n);
+                    return substring_insert(pos, pos.size(), s, n);
                 }
                 basic_multi_string &substring_append(const_iterator pos, const char_type *s) {
-                    return substring_insert(pos, pos.priv.data->size, s);
+                    return substring_insert(pos, pos.size(), s);
                 }
                 template <class InputIt>
                 basic_multi_string &substring_append(const_iterator pos, InputIt first, InputIt last) {
-                    substring_insert(pos, priv.string.begin()+pos.priv.data->size, first, last);
+                    substring_insert(pos, priv.string.begin()+pos.size(), first, last);
                     return *this;
                 }
                 basic_multi_string &substring_append(const_iterator pos, std::initializer_list <char_type> il) {
-                    return substring_insert(pos, pos.priv.data->size, il);
+                    return substring_insert(pos, pos.size(), il);
                 }
                 template <class StringViewLike>
                 requires (std::is_convertible_v<StringViewLike, string_view_type> && !std::is_convertible_v<StringViewLike, const char_type*>)
                 basic_multi_string &substring_append(const_iterator pos, const StringViewLike& t) {
-                    return substring_insert(pos, pos.priv.data->size, t);
+                    return substring_insert(pos, pos.size(), t);
                 }
                 template <class StringViewLike>
                 requires (std::is_convertible_v<StringViewLike, string_view_type> && !std::is_convertible_v<StringViewLike, const char_type*>)
                 basic_multi_string &substring_append(const_iterator pos, const StringViewLike& t, size_type t_index, size_type count = npos) {
-                    return substring_insert(pos, pos.priv.data->size, t, t_index, count);
+                    return substring_insert(pos, pos.size(), t, t_index, count);
                 }
             /*`compare`*/
                 int substring_compare(const_iterator pos, const string_type& str) const noexcept {
-                    return priv.string.compare(pos.priv.data->index, pos.priv.data->size, str);
+                    return priv.string.compare(pos.index(), pos.size(), str);
                 }
                 int substring_compare(const_iterator pos, size_type s_pos, size_type len, const string_type& str) const {
-                    return priv.string.compare(pos.priv.data->index + s_pos, len, str);
+                    return priv.string.compare(pos.index() + s_pos, len, str);
                 }
                 int substring_compare(const_iterator pos, size_type s_pos, size_type len, const string_type& str, size_type subpos, size_type sublen = string_type::npos) const {
-                    return priv.string.compare(pos.priv.data->index + s_pos, len, str, subpos, sublen);
+                    return priv.string.compare(pos.index() + s_pos, len, str, subpos, sublen);
                 }
                 int substring_compare(const_iterator pos, const char_type* s) const {
-                    return priv.string.compare(pos.priv.data->index, pos.priv.data->size, s);
+                    return priv.string.compare(pos.index(), pos.size(), s);
                 }
                 int substring_compare(const_iterator pos, size_type s_pos, size_type len, const char_type* s) const {
-                    return priv.string.compare(pos.priv.data->index + s_pos, len, s);
+                    return priv.string.compare(pos.index() + s_pos, len, s);
                 }
                 int substring_compare(const_iterator pos, size_type s_pos, size_type len, const char_type* s, size_type n) const {
-                    return priv.string.compare(pos.priv.data->index + s_pos, len, s, n);
+                    return priv.string.compare(pos.index() + s_pos, len, s, n);
                 }
                 template<class StringViewLike>
                 requires (std::is_convertible_v<StringViewLike, string_view_type> && !std::is_convertible_v<StringViewLike, const char_type*>)
                 int substring_compare(const_iterator pos, const StringViewLike& t) const noexcept {
-                    return priv.string.compare(pos.priv.data->index, pos.priv.data->size, t);
+                    return priv.string.compare(pos.index(), pos.size(), t);
                 }
                 template<class StringViewLike>
                 requires (std::is_convertible_v<StringViewLike, string_view_type> && !std::is_convertible_v<StringViewLike, const char_type*>)
                 int substring_compare(const_iterator pos, size_type s_pos1, size_type count1, const StringViewLike& t ) const {
-                    return priv.string.compare(pos.priv.data->index + s_pos1, count1, t);
+                    return priv.string.compare(pos.index() + s_pos1, count1, t);
                 }
                 template<class StringViewLike>
                 requires (std::is_convertible_v<StringViewLike, string_view_type> && !std::is_convertible_v<StringViewLike, const char_type*>)
                 int substring_compare(const_iterator pos, size_type s_pos1, size_type count1, const StringViewLike& t, size_type s_pos2, size_type count2 = npos) const {
-                    return priv.string.compare(pos.priv.data->index + s_pos1, count1, t, s_pos2, count2);
+                    return priv.string.compare(pos.index() + s_pos1, count1, t, s_pos2, count2);
                 }
             /*`starts_with`*/
                 bool substring_starts_with(const_iterator pos, string_view_type sv) const noexcept {
-                    return std::string_view(priv.string.data() + pos.priv.data->index, pos.priv.data->size).starts_with(sv);
+                    return std::string_view(priv.string.data() + pos.index(), pos.size()).starts_with(sv);
                 }
                 bool substring_starts_with(const_iterator pos, char_type ch) const noexcept {
-                    return std::string_view(priv.string.data() + pos.priv.data->index, pos.priv.data->size).starts_with(ch);
+                    return std::string_view(priv.string.data() + pos.index(), pos.size()).starts_with(ch);
                 }
                 bool substring_starts_with(const_iterator pos, const char_type* s) const noexcept {
-                    return std::string_view(priv.string.data() + pos.priv.data->index, pos.priv.data->size).starts_with(s);
+                    return std::string_view(priv.string.data() + pos.index(), pos.size()).starts_with(s);
                 }
             /*`ends_with`*/
                 bool substring_ends_with(const_iterator pos, string_view_type sv) const noexcept {
-                    return std::string_view(priv.string.data()+pos.priv.data->index, pos.priv.data->size).ends_with(sv);
+                    return std::string_view(priv.string.data()+pos.index(), pos.size()).ends_with(sv);
                 }
                 bool substring_ends_with(const_iterator pos, char_type ch) const noexcept {
-                    return std::string_view(priv.string.data()+pos.priv.data->index, pos.priv.data->size).ends_with(ch);
+                    return std::string_view(priv.string.data()+pos.index(), pos.size()).ends_with(ch);
                 }
                 bool substring_ends_with(const_iterator pos, const char_type* s) const noexcept {
-                    return std::string_view(priv.string.data()+pos.priv.data->index, pos.priv.data->size).ends_with(s);
+                    return std::string_view(priv.string.data()+pos.index(), pos.size()).ends_with(s);
                 }
             /*`contains`*/
                 bool substring_contains(const_iterator pos, string_view_type sv) const noexcept {
-                    return std::string_view(priv.string.data()+pos.priv.data->index, pos.priv.data->size).find(sv) != npos;
+                    return std::string_view(priv.string.data()+pos.index(), pos.size()).find(sv) != npos;
                 }
                 bool substring_contains(const_iterator pos, char_type ch) const noexcept {
-                    return std::string_view(priv.string.data()+pos.priv.data->index, pos.priv.data->size).find(ch) != npos;
+                    return std::string_view(priv.string.data()+pos.index(), pos.size()).find(ch) != npos;
                 }
                 bool substring_contains(const_iterator pos, const char_type * s) const {
-                    return std::string_view(priv.string.data()+pos.priv.data->index, pos.priv.data->size).find(s) != npos;
+                    return std::string_view(priv.string.data()+pos.index(), pos.size()).find(s) != npos;
                 }
             /*`replace`*/
                 basic_multi_string& substring_replace(const_iterator pos, size_type s_pos, size_type count, const string_type& str ) {
+                    priv.relocate(pos);
                     ssize_t change = priv.string.size();
-                    priv.string.replace(s_pos + pos.priv.data->index, count, str);
+                    priv.string.replace(s_pos + pos.index(), count, str);
                     change = priv.string.size() - change;
-                    priv::nodes_shift_change(pos, change);
+                    priv.shift(pos, change);
                     return *this;
                 }
                 basic_multi_string& substring_replace(const_iterator pos, string_type_const_iterator first, string_type_const_iterator last, const string_type& str ) {
+                    priv.relocate(pos, first, last);
                     ssize_t change = priv.string.size();
                     priv.string.replace(first, last, str);
                     change = priv.string.size() - change;
-                    priv::nodes_shift_change(pos, change);
+                    priv.shift(pos, change);
                     return *this;
                 }
                 basic_multi_string& substring_replace(const_iterator pos, size_type s_pos, size_type count, const string_type& str, size_type s_pos2, size_type count2 = npos ) {
+                    priv.relocate(pos);
                     ssize_t change = priv.string.size();
-                    priv.string.replace(s_pos + pos.priv.data->index, count, str, s_pos2, count2);
+                    priv.string.replace(s_pos + pos.index(), count, str, s_pos2, count2);
                     change = priv.string.size() - change;
-                    priv::nodes_shift_change(pos, change);
+                    priv.shift(pos, change);
                     return *this;
                 }
                 basic_multi_string& substring_replace(const_iterator pos, size_type s_pos, size_type count, const char_type* cstr, size_type count2 ) {
+                    priv.relocate(pos);
                     ssize_t change = priv.string.size();
-                    priv.string.replace(s_pos + pos.priv.data->index, count, cstr, count2);
+                    priv.string.replace(s_pos + pos.index(), count, cstr, count2);
                     change = priv.string.size() - change;
-                    priv::nodes_shift_change(pos, change);
+                    priv.shift(pos, change);
                     return *this;
                 }
                 basic_multi_string& substring_replace(const_iterator pos, string_type_const_iterator first, string_type_const_iterator last, const char_type* cstr, size_type count2 ) {
+                    priv.relocate(pos, first, last);
                     ssize_t change = priv.string.size();
                     priv.string.replace(first, last, cstr, count2);
                     change = priv.string.size() - change;
-                    priv::nodes_shift_change(pos, change);
+                    priv.shift(pos, change);
                     return *this;
                 }
                 basic_multi_string& substring_replace(const_iterator pos, size_type s_pos, size_type count, const char_type *cstr ) {
+                    priv.relocate(pos);
                     ssize_t change = priv.string.size();
-                    priv.string.replace(s_pos + pos.priv.data->index, count, cstr);
+                    priv.string.replace(s_pos + pos.index(), count, cstr);
                     change = priv.string.size() - change;
-                    priv::nodes_shift_change(pos, change);
+                    priv.shift(pos, change);
                     return *this;
                 }
                 basic_multi_string& substring_replace(const_iterator pos, string_type_const_iterator first, string_type_const_iterator last, const char_type* cstr ) {
+                    priv.relocate(pos, first, last);
                     ssize_t change = priv.string.size();
                     priv.string.replace(first, last, cstr);
                     change = priv.string.size() - change;
-                    priv::nodes_shift_change(pos, change);
+                    priv.shift(pos, change);
                     return *this;
                 }
                 basic_multi_string& substring_replace(const_iterator pos, size_type s_pos, size_type count, size_type count2, char_type ch ) {
+                    priv.relocate(pos);
                     ssize_t change = priv.string.size();
-                    priv.string.replace(s_pos + pos.priv.data->index, count, count2, ch);
+                    priv.string.replace(s_pos + pos.index(), count, count2, ch);
                     change = priv.string.size() - change;
-                    priv::nodes_shift_change(pos, change);
+                    priv.shift(pos, change);
                     return *this;
                 }
                 template< class InputIt >
                 basic_multi_string& substring_replace(const_iterator pos, string_type_const_iterator first, string_type_const_iterator last, InputIt first2, InputIt last2 ) {
+                    priv.relocate(pos, first, last);
                     ssize_t change = priv.string.size();
                     priv.string.replace(first, last, first2, last2);
                     change = priv.string.size() - change;
-                    priv::nodes_shift_change(pos, change);
+                    priv.shift(pos, change);
                     return *this;
                 }
                 basic_multi_string& substring_replace(const_iterator pos, string_type_const_iterator first, string_type_const_iterator last, std::initializer_list<char_type> ilist ) {
+                    priv.relocate(pos, first, last);
                     ssize_t change = priv.string.size();
                     priv.string.replace(first, last, ilist);
                     change = priv.string.size() - change;
-                    priv::nodes_shift_change(pos, change);
+                    priv.shift(pos, change);
                     return *this;
                 }
                 template< class StringViewLike >
                 requires (std::is_convertible_v<StringViewLike, string_view_type> && !std::is_convertible_v<StringViewLike, const char_type*>)
                 basic_multi_string& substring_replace(const_iterator pos, size_type s_pos, size_type count, const StringViewLike& t ) {
+                    priv.relocate(pos);
                     ssize_t change = priv.string.size();
-                    priv.string.replace(s_pos + pos.priv.data->index, count, t);
+                    priv.string.replace(s_pos + pos.index(), count, t);
                     change = priv.string.size() - change;
-                    priv::nodes_shift_change(pos, change);
+                    priv.shift(pos, change);
                     return *this;
                 }
                 template< class StringViewLike >
                 requires (std::is_convertible_v<StringViewLike, string_view_type> && !std::is_convertible_v<StringViewLike, const char_type*>)
                 basic_multi_string& substring_replace(const_iterator pos, string_type_const_iterator first, string_type_const_iterator last, const StringViewLike& t ) {
+                    priv.relocate(pos, first, last);
                     ssize_t change = priv.string.size();
                     priv.string.replace(first, last, t);
                     change = priv.string.size() - change;
-                    priv::nodes_shift_change(pos, change);
+                    priv.shift(pos, change);
                     return *this;
                 }
                 template< class StringViewLike >
                 requires (std::is_convertible_v<StringViewLike, string_view_type> && !std::is_convertible_v<StringViewLike, const char_type*>)
                 basic_multi_string& substring_replace(const_iterator pos, size_type s_pos, size_type count, const StringViewLike& t, size_type s_pos2, size_type count2 = npos ) {
+                    priv.relocate(pos);
                     ssize_t change = priv.string.size();
-                    priv.string.replace(s_pos + pos.priv.data->index, count, t, s_pos2, count2);
+                    priv.string.replace(s_pos + pos.index(), count, t, s_pos2, count2);
                     change = priv.string.size() - change;
-                    priv::nodes_shift_change(pos, change);
+                    priv.shift(pos, change);
                     return *this;
                 }
             /*`substring`*/
                 string_type substring(size_type pos) const {return substring(begin()+pos);}
                 string_type substring(const_reverse_iterator pos) const {return substring(pos.base());}
                 string_type substring(const_iterator pos) const {
-                    return priv.string.substr(pos.priv.data->index, pos.priv.data->size);
+                    return priv.string.substr(pos.index(), pos.size());
                 }
             /*`substring_view`*/
                 string_view_type substring_view(size_type pos) const {return substring_view(begin()+pos);}
                 string_view_type substring_view(const_reverse_iterator pos) const {return substring_view(pos.base());}
                 string_view_type substring_view(const_iterator pos) const {
-                    return string_view_type(priv.string.data() + pos.priv.data->index, pos.priv.data->size);
+                    return string_view_type(priv.string.data() + pos.index(), pos.size());
                 }
             /*`substring_substr`*/
                 string_type substring_substr(size_type pos) const {return substring_substr(begin()+pos);}
                 string_type substring_substr(const_reverse_iterator pos) const {return substring_substr(pos.base());}
                 string_type substring_substr(const_iterator pos, size_type s_pos = 0, size_type count = npos ) const {
-                    return priv.string.substr(pos.priv.data->index + s_pos, (count == npos) ? pos.priv.data->size - s_pos : count);
+                    return priv.string.substr(pos.index() + s_pos, (count == npos) ? pos.size() - s_pos : count);
                 }
             /*`substring_substrview`*/
                 string_view_type substring_substrview(size_type pos) const {return substring_substrview(begin()+pos);}
                 string_view_type substring_substrview(const_reverse_iterator pos) const {return substring_substrview(pos.base());}
                 string_view_type substring_substrview(const_iterator pos, size_type s_pos = 0, size_type count = npos) const {
-                    return string_view_type(priv.string.data() + s_pos + pos.priv.data->index, (count == npos) ? pos.priv.data->size - s_pos : count);
+                    return string_view_type(priv.string.data() + s_pos + pos.index(), (count == npos) ? pos.size() - s_pos : count);
                 }
             /*`substring_copy`*/
                 string_view_type substring_copy(size_type pos) const {return substring_copy(begin()+pos);}
                 string_view_type substring_copy(const_reverse_iterator pos) const {return substring_copy(pos.base());}
                 size_type substring_copy(const_iterator pos, char_type* dest, size_type count, size_type s_pos = 0 ) const {
-                    return priv.string.copy(dest, count, s_pos + pos.priv.data->index);
+                    return priv.string.copy(dest, count, s_pos + pos.index());
                 }
             /*`resize`*/
                 template <typename ...Types>
@@ -1292,23 +1812,20 @@ template <
                     substring_resize(pos, n, '\0');
                 }
                 void substring_resize(const_iterator pos, size_type n, char_type ch) {
-                    if (n == pos.priv.data->size)
+                    if (n == pos.size())
                         return;
-                    if (n < pos.priv.data->size) {
-                        substring_erase(pos, pos.priv.data->size-n);
+                    if (n < pos.size()) {
+                        substring_erase(pos, n);
                     } else {
-                        substring_insert(pos, pos.priv.data->size, n - pos.priv.data->size, ch);
+                        substring_insert(pos, pos.size(), n - pos.size(), ch);
                     }
                     if constexpr (sizeof(char_type)==1) {
-                        memset(priv.string.data()+pos.priv.data->index, ch, pos.priv.data->size);
+                        memset(priv.string.data()+pos.index(), ch, pos.size());
                     } else {
-                        for (size_t i = pos.priv.data->index, i_end = pos.priv.data->index+pos.priv.data->size; i < i_end; ++i) {
+                        for (size_t i = pos.index(), i_end = pos.index()+pos.size(); i < i_end; ++i) {
                             priv.string[i] = ch;
                         }
                     }
-                    pos.priv.data->size = n;
-                    
-                    // substring_insert(pos, pos.priv.data->size - n, n, ch);
                 }
                 
         /*Building Substring operations*/
@@ -1826,6 +2343,65 @@ template <
                     return priv.string.find_last_not_of(c, priv.buildingIndex + pos);
                 }        
 
+    /*`Arena`*/
+        /* In arena mode a substring that is edited is first copied to the end, in front of the building substring,
+                and its old characters become garbage, so an edit costs the length of the substring
+                instead of moving the rest of the string. Erased substrings become garbage as well.
+            The garbage is compacted away once it is more than half of the string, or by compact().
+            The cumulative string includes the garbage and is in node order only after compaction.
+        */
+        void arena_mode(bool enable) requires (!packed) {
+            if (priv.arena && !enable)
+                priv.compact();
+            if (enable)
+                priv.emptyAtBuilding = true;
+            priv.arena = enable;
+        }
+        bool arena_mode() const {
+            return priv.arena;
+        }
+        size_type garbage_size() const {
+            return priv.garbage;
+        }
+        /* Rewrites the cumulative string with the substrings in order and without garbage. */
+        void compact() {
+            priv.compact();
+        }
+
+    /*`Write`*/
+        /* Writes the substrings in the format of multi_string_file_header with a single gathering write,
+                straight from the cumulative string unless arena mode has it out of order.
+            The building substring is not written. Returns false if the file could not be written.
+        */
+        bool write(const std::filesystem::path &path) const {
+            std::vector<uint64_t> offsets(priv.nodes.size() + 1);
+            string_type gathered;
+            string_view_type blob(priv.string.data(), priv.buildingIndex);
+            if (priv.arena) {
+                gathered.reserve(priv.string.size() - priv.garbage);
+                for (size_type i = 0; i < priv.nodes.size(); ++i) {
+                    offsets[i] = gathered.size();
+                    gathered.append(priv.string, priv.index(i), priv.size(i));
+                }
+                blob = gathered;
+            } else {
+                for (size_type i = 0; i < priv.nodes.size(); ++i)
+                    offsets[i] = priv.index(i);
+            }
+            offsets.back() = blob.size();
+            multi_string_file_header header {};
+            std::copy(std::begin(header.signature), std::end(header.signature), header.magic);
+            header.version = multi_string_file_header::current_version;
+            header.char_size = sizeof(char_type);
+            header.count = priv.nodes.size();
+            header.blob_size = blob.size();
+            return file::write(path, {
+                {&header, sizeof(header)},
+                {offsets.data(), offsets.size() * sizeof(uint64_t)},
+                {blob.data(), blob.size() * sizeof(char_type)}
+            });
+        }
+
     /*`Read`*/
     bool pushf(file::info info) {
         priv.string.resize(cumulative_size()+info.size());
@@ -1842,13 +2418,210 @@ template <
             return file::result_type<const_iterator>{.result=pos,.success=false};
         }
         
-        size_t iteratorIndex = pos-begin();
-        priv.nodes.insert(priv.nodes.begin()+(iteratorIndex), node_type{pos.priv.data->index, 0});
-        file::result_type<const_iterator> resultValue{.result=begin()+iteratorIndex, .success=true};
+        file::result_type<const_iterator> resultValue{.result=insert(pos, string_view_type()), .success=true};
         substring_resize(resultValue.result, info.size());
         info.read((void*)substring_view(resultValue.result).data());
         return resultValue;
     }
+
+    /*`Split`*/
+        /* Appends the substrings of view separated by delimiter, including empty ones, with one scan for the delimiters. */
+        void split(string_view_type view, char_type delimiter) {
+            priv.check_bounds(priv.string.size() + view.size());
+            priv.string.insert(priv.buildingIndex, view);
+            priv.split(view.size(), delimiter, false);
+        }
+        /* Appends the lines of a file, read straight into the cumulative string and split there.
+            A carriage return ending a line is dropped, and so is a last empty line after the final line feed.
+            More than one thread scans parts of the file for line feeds at once.
+            Returns false if the file does not exist.
+        */
+        bool load_lines(const std::filesystem::path &path, unsigned threads = 1) {
+            file::info info(path);
+            if (!info.exists())
+                return false;
+            size_type length = info.size() / sizeof(char_type);
+            priv.check_bounds(priv.string.size() + length);
+            priv.string.insert(priv.buildingIndex, length, char_type());
+            file::read(path, priv.string.data() + priv.buildingIndex, length * sizeof(char_type));
+            priv.split(length, char_type('\n'), true, threads);
+            return true;
+        }
+
+    /*`Sort`*/
+        /* Sorts the substrings in the order of string_view_type comparison with an MSD radix sort,
+                more than one thread sorts separate buckets at once. Wider characters are sorted by comparison.
+            In arena mode only the nodes are permuted, otherwise the cumulative string is rewritten in the new order.
+        */
+        void sort(unsigned threads = 1) {
+            priv.sort(threads);
+        }
+        /* The following require the substrings to be sorted. */
+        const_iterator lower_bound(string_view_type value) const {
+            return begin() + (std::partition_point(priv.nodes.begin(), priv.nodes.end(), [&](const node_type &node) {
+                return (*this)[&node - priv.nodes.data()] < value;
+            }) - priv.nodes.begin());
+        }
+        const_iterator upper_bound(string_view_type value) const {
+            return begin() + (std::partition_point(priv.nodes.begin(), priv.nodes.end(), [&](const node_type &node) {
+                return !(value < (*this)[&node - priv.nodes.data()]);
+            }) - priv.nodes.begin());
+        }
+        std::pair<const_iterator, const_iterator> equal_range(string_view_type value) const {
+            return {lower_bound(value), upper_bound(value)};
+        }
+
+    /*`Hash Index`*/
+        /* The hash index finds the first substring equal to a value in constant expected time.
+            It follows push_back, erase, pop_back, resize, split and sort, but inserting nodes before the end
+                or editing substrings leaves it invalid until rebuild_hash_index(), lookups are linear meanwhile.
+            Writes through the cumulative iterators or data are not seen by it either.
+        */
+        void hash_index(bool enable) {
+            priv.table = {};
+            priv.table.enabled = enable;
+            if (enable)
+                priv.table_build();
+        }
+        bool hash_index() const {
+            return priv.table.enabled;
+        }
+        bool hash_index_valid() const {
+            return priv.table.valid;
+        }
+        void rebuild_hash_index() {
+            if (priv.table.enabled)
+                priv.table_build();
+        }
+        /* The first substring equal to value, or end(). */
+        const_iterator lookup(string_view_type value) const {
+            if (priv.table.valid) {
+                size_type slot = priv.table_find(value, priv.table_hash(value));
+                return slot == npos ? end() : begin() + priv.table.slots[slot];
+            }
+            for (size_type pos = 0; pos < priv.nodes.size(); ++pos) {
+                if (priv.view(pos) == value)
+                    return begin() + pos;
+            }
+            return end();
+        }
+
+    /*`Edit Batch`*/
+        /* Edits of substrings collected by node position and applied together by apply(),
+                which rewrites the cumulative string and the nodes in one pass from left to right,
+                instead of moving everything after a substring for each edit.
+            Edits of the same node apply in the order they were added, each to the result of the ones before it.
+            Nothing changes until apply(), and nothing changes if it throws, so dropping a batch discards its edits.
+        */
+        class batch_type {
+            public:
+                batch_type(basic_multi_string &parent) : priv{.parent=parent,.edits={},.text={}} {}
+                /* Replaces count characters at index of the substring at pos with str, index npos is the end of the substring. */
+                batch_type &replace(size_type pos, size_type index, size_type count, string_view_type str) {
+                    if (pos >= priv.parent.size()) {
+                        throw std::out_of_range("Index out of bounds.");
+                    }
+                    priv.edits.push_back({pos, index, count, priv.text.size(), str.size()});
+                    priv.text.append(str);
+                    return *this;
+                }
+                batch_type &assign(size_type pos, string_view_type str) {
+                    return replace(pos, 0, npos, str);
+                }
+                batch_type &insert(size_type pos, size_type index, string_view_type str) {
+                    return replace(pos, index, 0, str);
+                }
+                batch_type &erase(size_type pos, size_type index = 0, size_type count = npos) {
+                    return replace(pos, index, count, string_view_type());
+                }
+                batch_type &append(size_type pos, string_view_type str) {
+                    return replace(pos, npos, 0, str);
+                }
+                bool empty() const {
+                    return priv.edits.empty();
+                }
+                size_type size() const {
+                    return priv.edits.size();
+                }
+                void clear() {
+                    priv.edits.clear();
+                    priv.text.clear();
+                }
+                /* Applies the edits and clears the batch. Runs of substrings without edits are copied at once,
+                    in arena mode substrings are copied one by one and the garbage is left behind.
+                    Throws std::out_of_range, changing nothing, if an edit begins past the end of its substring.
+                */
+                void apply() {
+                    auto &parent = priv.parent.priv;
+                    size_type count = parent.nodes.size();
+                    std::stable_sort(priv.edits.begin(), priv.edits.end(), [](const edit &lhs, const edit &rhs) {
+                        return lhs.pos < rhs.pos;
+                    });
+                    if (!priv.edits.empty() && priv.edits.back().pos >= count) {
+                        throw std::out_of_range("Index out of bounds.");
+                    }
+                    string_type rebuilt, edited;
+                    rebuilt.reserve(parent.string.size() - parent.garbage + priv.text.size());
+                    std::vector<node_type> nodes(count);
+                    auto it = priv.edits.begin();
+                    for (size_type i = 0; i < count;) {
+                        size_type next = (it == priv.edits.end()) ? count : it->pos;
+                        if (i < next && !parent.arena) {
+                            size_type from = parent.index(i), shift = rebuilt.size() - from;
+                            rebuilt.append(parent.string, from, parent.insertion_index(next) - from);
+                            for (; i < next; ++i)
+                                nodes[i] = make_node(parent.index(i) + shift, parent.size(i));
+                            continue;
+                        }
+                        size_type index = rebuilt.size();
+                        if (i < next) {
+                            rebuilt.append(parent.view(i));
+                        } else {
+                            edited.assign(parent.view(i));
+                            for (; it != priv.edits.end() && it->pos == i; ++it) {
+                                size_type at = (it->index == npos) ? edited.size() : it->index;
+                                if (at > edited.size()) {
+                                    throw std::out_of_range("Index out of bounds.");
+                                }
+                                edited.replace(at, it->count, priv.text, it->text, it->size);
+                            }
+                            rebuilt.append(edited);
+                        }
+                        nodes[i++] = make_node(index, rebuilt.size() - index);
+                    }
+                    size_type building = rebuilt.size();
+                    rebuilt.append(parent.string, parent.buildingIndex);
+                    parent.check_bounds(rebuilt.size());
+                    parent.string.swap(rebuilt);
+                    parent.nodes.swap(nodes);
+                    parent.buildingIndex = building;
+                    parent.garbage = 0;
+                    parent.emptyAtBuilding = true;
+                    if (parent.table.enabled)
+                        parent.table_build();
+                    clear();
+                }
+            private:
+                static node_type make_node(size_type index, size_type size) {
+                    return basic_multi_string::priv::make_node(index, size);
+                }
+                struct edit {
+                    size_type pos;
+                    size_type index;
+                    size_type count;
+                    /* Characters of the replacement in text. */
+                    size_type text;
+                    size_type size;
+                };
+                struct priv {
+                    basic_multi_string &parent;
+                    std::vector<edit> edits;
+                    string_type text;
+                } priv;
+        };
+        batch_type edit_batch() {
+            return batch_type(*this);
+        }
 };
 
 
@@ -1857,6 +2630,9 @@ using wmulti_string = basic_multi_string<wchar_t>;
 using u8multi_string = basic_multi_string<char8_t>;
 using u16multi_string = basic_multi_string<char16_t>;
 using u32multi_string = basic_multi_string<char32_t>;
+using multi_string32 = basic_multi_string<char, uint32_t>;
+using packed_multi_string = basic_multi_string<char, size_t, true>;
+using packed_multi_string32 = basic_multi_string<char, uint32_t, true>;
 
 };
 #endif
\ No newline at end of file
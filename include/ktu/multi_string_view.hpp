@@ -0,0 +1,174 @@
+#ifndef KTU__MULTI_STRING_VIEW_HPP
+#define KTU__MULTI_STRING_VIEW_HPP
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <compare>
+#include <filesystem>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+#include <ktu/memory/file.hpp>
+#include <ktu/multi_string.hpp>
+
+namespace ktu {
+/* A read-only multi_string over a file written by basic_multi_string::write.
+    The file is mapped and the substrings are served from the mapping, opening it only checks the header.
+*/
+template <
+    class CharT
+> class basic_multi_string_view {
+    public:
+    using char_type = CharT;
+    using size_type = size_t;
+    using ssize_type = ssize_t;
+    using string_view_type = std::basic_string_view<char_type>;
+    using header_type = multi_string_file_header;
+
+    class const_iterator {
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using iterator_concept = std::random_access_iterator_tag;
+            const_iterator(const basic_multi_string_view &parent, const uint64_t *data) : priv{.data=data,.parent=parent} {}
+            const_iterator &operator++() {
+                ++priv.data;
+                return *this;
+            }
+            const_iterator &operator--() {
+                --priv.data;
+                return *this;
+            }
+            const_iterator &operator+=(ssize_type diff) {
+                priv.data += diff;
+                return *this;
+            }
+            const_iterator &operator-=(ssize_type diff) {
+                priv.data -= diff;
+                return *this;
+            }
+            friend size_type operator-(const_iterator lhs, const_iterator rhs) {
+                return lhs.priv.data - rhs.priv.data;
+            }
+            friend const_iterator operator+(const_iterator obj, ssize_type diff) {
+                return const_iterator(obj.priv.parent, obj.priv.data + diff);
+            }
+            friend const_iterator operator-(const_iterator obj, ssize_type diff) {
+                return const_iterator(obj.priv.parent, obj.priv.data - diff);
+            }
+            string_view_type operator*() const {
+                return string_view_type{data(), size()};
+            }
+            bool operator==(const const_iterator &other) const {
+                return priv.data == other.priv.data;
+            }
+            std::weak_ordering operator<=>(const const_iterator &other) const {
+                return priv.data <=> other.priv.data;
+            }
+            const char_type *data() const {
+                return priv.parent.priv.blob + index();
+            }
+            size_t index() const {
+                return priv.data[0];
+            }
+            size_t size() const {
+                return priv.data[1] - priv.data[0];
+            }
+        private:
+            struct priv {
+                const uint64_t *data;
+                const basic_multi_string_view &parent;
+            } priv;
+    };
+
+    private:
+    struct priv {
+        file::mapping mapping;
+        const uint64_t *offsets = nullptr;
+        const char_type *blob = nullptr;
+        size_type count = 0;
+    } priv;
+
+    public:
+    /*`Main`*/
+        basic_multi_string_view() {}
+        basic_multi_string_view(const std::filesystem::path &path) {
+            open(path);
+        }
+        /* Maps the file, returns false and stays empty if it is missing or its header does not match its size. */
+        bool open(const std::filesystem::path &path) {
+            close();
+            file::mapping mapping(path);
+            if (mapping.size() < sizeof(header_type))
+                return false;
+            const header_type &header = *(const header_type*)mapping.data();
+            if (
+                !std::equal(std::begin(header.magic), std::end(header.magic), std::begin(header_type::signature)) ||
+                header.version != header_type::current_version ||
+                header.char_size != sizeof(char_type) ||
+                header.count >= (mapping.size() - sizeof(header_type)) / sizeof(uint64_t) ||
+                mapping.size() - sizeof(header_type) - (header.count + 1) * sizeof(uint64_t) != header.blob_size * sizeof(char_type)
+            ) return false;
+            priv.offsets = (const uint64_t*)(&header + 1);
+            if (priv.offsets[header.count] != header.blob_size)
+                return false;
+            priv.blob = (const char_type*)(priv.offsets + header.count + 1);
+            priv.count = header.count;
+            priv.mapping = std::move(mapping);
+            return true;
+        }
+        void close() {
+            priv = {};
+        }
+        bool is_open() const {
+            return bool(priv.mapping);
+        }
+
+    /*`Element Access`*/
+        string_view_type at(size_type pos) const {
+            if (pos >= priv.count) {
+                throw std::out_of_range("Index out of bounds.");
+            }
+            return (*this)[pos];
+        }
+        string_view_type operator[](size_type pos) const {
+            return string_view_type(priv.blob + priv.offsets[pos], priv.offsets[pos + 1] - priv.offsets[pos]);
+        }
+        string_view_type front() const {
+            return (*this)[0];
+        }
+        string_view_type back() const {
+            return (*this)[priv.count - 1];
+        }
+        /* The substrings one after another, as in the cumulative string of a multi_string without a building substring. */
+        string_view_type cumulative_view() const {
+            return string_view_type(priv.blob, priv.count ? priv.offsets[priv.count] : 0);
+        }
+
+    /*`Iterators`*/
+        const_iterator begin() const {
+            return const_iterator(*this, priv.offsets);
+        }
+        const_iterator end() const {
+            return const_iterator(*this, priv.offsets + priv.count);
+        }
+
+    /*`Capacity`*/
+        bool empty() const {
+            return !priv.count;
+        }
+        size_type size() const {
+            return priv.count;
+        }
+        void swap(basic_multi_string_view &other) {
+            std::swap(priv, other.priv);
+        }
+};
+
+using multi_string_view = basic_multi_string_view<char>;
+using wmulti_string_view = basic_multi_string_view<wchar_t>;
+using u8multi_string_view = basic_multi_string_view<char8_t>;
+using u16multi_string_view = basic_multi_string_view<char16_t>;
+using u32multi_string_view = basic_multi_string_view<char32_t>;
+
+};
+#endif
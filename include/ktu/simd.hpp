@@ -0,0 +1,210 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <bit>
+#if defined(__AVX2__) || defined(__SSE2__)
+    #include <immintrin.h>
+#endif
+#include <ktu/macros/inline.hpp>
+
+namespace ktu {
+    namespace simd {
+
+        /* Number of bytes classified per block. */
+        inline constexpr size_t width = 64;
+
+        /* Carry-less prefix sum of a bitmask, every bit becomes the parity of itself and all bits below it.
+            Used to turn a mask of quote characters into a mask of the bytes between them.
+        */
+        KTU_INLINE uint64_t prefix_xor(uint64_t mask) {
+            #if defined(__PCLMUL__)
+                return (uint64_t)_mm_cvtsi128_si64(
+                    _mm_clmulepi64_si128(_mm_set_epi64x(0, (long long)mask), _mm_set1_epi8((char)0xFF), 0)
+                );
+            #else
+                mask ^= mask << 1;
+                mask ^= mask << 2;
+                mask ^= mask << 4;
+                mask ^= mask << 8;
+                mask ^= mask << 16;
+                mask ^= mask << 32;
+                return mask;
+            #endif
+        }
+
+        /* Returns a mask of the lowest `size` bits, size may be up to 64. */
+        KTU_INLINE constexpr uint64_t low_bits(size_t size) {
+            return (size >= 64) ? ~uint64_t(0) : ((uint64_t(1) << size) - 1);
+        }
+
+        /* Removes and returns the index of the lowest set bit, the mask must be non-zero. */
+        KTU_INLINE unsigned pop_lowest(uint64_t &mask) {
+            unsigned index = (unsigned)std::countr_zero(mask);
+            mask &= mask - 1;
+            return index;
+        }
+
+        /* A 64 byte window of input.
+            Every classification returns one bit per byte, where bit 0 corresponds to the first byte.
+        */
+        class block {
+            public:
+                KTU_INLINE block(const void *ptr) {
+                    #if defined(__AVX2__)
+                        chunk[0] = _mm256_loadu_si256((const __m256i*)ptr);
+                        chunk[1] = _mm256_loadu_si256((const __m256i*)ptr + 1);
+                    #elif defined(__SSE2__)
+                        for (int i = 0; i < 4; i++)
+                            chunk[i] = _mm_loadu_si128((const __m128i*)ptr + i);
+                    #else
+                        memcpy(chunk, ptr, width);
+                    #endif
+                }
+
+                /* Loads fewer than 64 bytes, the remainder of the block is set to `fill`.
+                    Never reads past ptr + size.
+                */
+                static KTU_INLINE block partial(const void *ptr, size_t size, uint8_t fill = 0) {
+                    alignas(64) uint8_t tmp[width];
+                    memset(tmp, fill, width);
+                    memcpy(tmp, ptr, size);
+                    return block(tmp);
+                }
+
+                /* Bytes equal to c. */
+                KTU_INLINE uint64_t eq(uint8_t c) const {
+                    #if defined(__AVX2__)
+                        __m256i v = _mm256_set1_epi8((char)c);
+                        return join(_mm256_cmpeq_epi8(chunk[0], v), _mm256_cmpeq_epi8(chunk[1], v));
+                    #elif defined(__SSE2__)
+                        __m128i v = _mm_set1_epi8((char)c);
+                        return join(
+                            _mm_cmpeq_epi8(chunk[0], v), _mm_cmpeq_epi8(chunk[1], v),
+                            _mm_cmpeq_epi8(chunk[2], v), _mm_cmpeq_epi8(chunk[3], v)
+                        );
+                    #else
+                        uint64_t mask = 0;
+                        for (size_t i = 0; i < width; i++)
+                            mask |= uint64_t(chunk[i] == c) << i;
+                        return mask;
+                    #endif
+                }
+
+                /* Bytes within the unsigned range [lo, hi]. */
+                KTU_INLINE uint64_t in(uint8_t lo, uint8_t hi) const {
+                    #if defined(__AVX2__)
+                        __m256i l = _mm256_set1_epi8((char)lo), d = _mm256_set1_epi8((char)(hi - lo));
+                        __m256i a = _mm256_sub_epi8(chunk[0], l), b = _mm256_sub_epi8(chunk[1], l);
+                        return join(
+                            _mm256_cmpeq_epi8(_mm256_min_epu8(a, d), a),
+                            _mm256_cmpeq_epi8(_mm256_min_epu8(b, d), b)
+                        );
+                    #elif defined(__SSE2__)
+                        __m128i l = _mm_set1_epi8((char)lo), d = _mm_set1_epi8((char)(hi - lo));
+                        __m128i r[4];
+                        for (int i = 0; i < 4; i++) {
+                            __m128i x = _mm_sub_epi8(chunk[i], l);
+                            r[i] = _mm_cmpeq_epi8(_mm_min_epu8(x, d), x);
+                        }
+                        return join(r[0], r[1], r[2], r[3]);
+                    #else
+                        uint64_t mask = 0;
+                        for (size_t i = 0; i < width; i++)
+                            mask |= uint64_t(uint8_t(chunk[i] - lo) <= uint8_t(hi - lo)) << i;
+                        return mask;
+                    #endif
+                }
+
+                /* Bytes below c, compared unsigned. */
+                KTU_INLINE uint64_t lt(uint8_t c) const {
+                    return (c) ? in(0, c - 1) : 0;
+                }
+
+                /* Bytes above c, compared unsigned. */
+                KTU_INLINE uint64_t gt(uint8_t c) const {
+                    return (c != 0xFF) ? in(c + 1, 0xFF) : 0;
+                }
+
+            private:
+                #if defined(__AVX2__)
+                    __m256i chunk[2];
+                    static KTU_INLINE uint64_t join(__m256i a, __m256i b) {
+                        return (uint64_t)(uint32_t)_mm256_movemask_epi8(a) | ((uint64_t)(uint32_t)_mm256_movemask_epi8(b) << 32);
+                    }
+                #elif defined(__SSE2__)
+                    __m128i chunk[4];
+                    static KTU_INLINE uint64_t join(__m128i a, __m128i b, __m128i c, __m128i d) {
+                        return
+                            (uint64_t)(uint16_t)_mm_movemask_epi8(a)         |
+                            ((uint64_t)(uint16_t)_mm_movemask_epi8(b) << 16) |
+                            ((uint64_t)(uint16_t)_mm_movemask_epi8(c) << 32) |
+                            ((uint64_t)(uint16_t)_mm_movemask_epi8(d) << 48);
+                    }
+                #else
+                    uint8_t chunk[width];
+                #endif
+        };
+
+        /* A 16 byte window of input, for runs that are usually short such as identifiers and numbers.
+            Classifications return one bit per byte in the low 16 bits.
+        */
+        class block16 {
+            public:
+                static constexpr size_t width = 16;
+
+                KTU_INLINE block16(const void *ptr) {
+                    #if defined(__SSE2__)
+                        chunk = _mm_loadu_si128((const __m128i*)ptr);
+                    #else
+                        memcpy(chunk, ptr, width);
+                    #endif
+                }
+
+                static KTU_INLINE block16 partial(const void *ptr, size_t size, uint8_t fill = 0) {
+                    alignas(16) uint8_t tmp[width];
+                    memset(tmp, fill, width);
+                    memcpy(tmp, ptr, size);
+                    return block16(tmp);
+                }
+
+                KTU_INLINE uint32_t eq(uint8_t c) const {
+                    #if defined(__SSE2__)
+                        return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8((char)c)));
+                    #else
+                        uint32_t mask = 0;
+                        for (size_t i = 0; i < width; i++)
+                            mask |= uint32_t(chunk[i] == c) << i;
+                        return mask;
+                    #endif
+                }
+
+                KTU_INLINE uint32_t in(uint8_t lo, uint8_t hi) const {
+                    #if defined(__SSE2__)
+                        __m128i x = _mm_sub_epi8(chunk, _mm_set1_epi8((char)lo));
+                        return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(x, _mm_set1_epi8((char)(hi - lo))), x));
+                    #else
+                        uint32_t mask = 0;
+                        for (size_t i = 0; i < width; i++)
+                            mask |= uint32_t(uint8_t(chunk[i] - lo) <= uint8_t(hi - lo)) << i;
+                        return mask;
+                    #endif
+                }
+
+                KTU_INLINE uint32_t lt(uint8_t c) const {
+                    return (c) ? in(0, c - 1) : 0;
+                }
+
+                KTU_INLINE uint32_t gt(uint8_t c) const {
+                    return (c != 0xFF) ? in(c + 1, 0xFF) : 0;
+                }
+
+            private:
+                #if defined(__SSE2__)
+                    __m128i chunk;
+                #else
+                    uint8_t chunk[width];
+                #endif
+        };
+
+    };
+};
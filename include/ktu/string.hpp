@@ -1,6 +1,12 @@
 #pragma once
 #include <cstdint>
+#include <cstring>
 #include <concepts>
+#include <charconv>
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <type_traits>
 namespace ktu {
 
     constexpr uint32_t ston32(const char *str) {
@@ -123,5 +129,192 @@ namespace ktu {
             return ston64(str);
         }
     }
+
+    namespace impl {
+        /* Value of a digit in bases up to 36, or 36 and above for any other character. */
+        constexpr unsigned digitValue(char c) {
+            if ('0' <= c && c <= '9') return c - '0';
+            if ('a' <= c && c <= 'z') return c - 'a' + 10;
+            if ('A' <= c && c <= 'Z') return c - 'A' + 10;
+            return 36;
+        }
+
+        /* Eight characters as an integer, the first in the lowest byte. */
+        inline uint64_t loadEight(const char *ptr) {
+            uint64_t value;
+            memcpy(&value, ptr, 8);
+            return value;
+        }
+
+        /* The high bit of every byte of x strictly between low and high, if all bytes of x are below 0x80. */
+        constexpr uint64_t bytesBetween(uint64_t x, uint64_t low, uint64_t high) {
+            constexpr uint64_t ones = 0x0101010101010101;
+            return (ones * (127 + high) - (x & ones * 127)) & ~x & ((x & ones * 127) + ones * (127 - low)) & ones * 128;
+        }
+
+        /* Amount of leading bytes of x marked by the high bit in mask. */
+        constexpr int leadingRun(uint64_t mask) {
+            return std::countr_zero(~mask & 0x8080808080808080) >> 3;
+        }
+
+        /* Keeps the first count characters of x as the last ones of eight, preceded by zeros. */
+        constexpr uint64_t alignDigits(uint64_t x, int count) {
+            return count == 8 ? x : (x << (64 - 8 * count)) | (0x3030303030303030 >> (8 * count));
+        }
+
+        /* Value of eight decimal digits, the first in the lowest byte. */
+        constexpr uint64_t parseEightDecimal(uint64_t x) {
+            x -= 0x3030303030303030;
+            x = x * 10 + (x >> 8);
+            return (((x & 0x000000FF000000FF) * (100 + (1000000ULL << 32))) +
+                (((x >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32)))) >> 32;
+        }
+
+        /* Value of eight hexadecimal digits of either case, the first in the lowest byte. */
+        constexpr uint64_t parseEightHex(uint64_t x) {
+            x = (x & 0x0F0F0F0F0F0F0F0F) + 9 * ((x >> 6) & 0x0101010101010101);
+            x = ((x << 4) | (x >> 8)) & 0x00FF00FF00FF00FF;
+            x = ((x << 8) | (x >> 16)) & 0x0000FFFF0000FFFF;
+            return ((x << 16) | (x >> 32)) & 0xFFFFFFFF;
+        }
+
+        constexpr uint64_t powersOf10[9] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+
+        struct magnitude {
+            const char *ptr;
+            uint64_t value;
+            bool overflow;
+        };
+
+        /* Parses the digits of an unsigned number, ptr must point to a digit.
+            Decimal and hexadecimal digits are taken eight at a time while the value cannot overflow.
+        */
+        constexpr magnitude parseMagnitude(const char *ptr, const char *last, unsigned base) {
+            magnitude result {ptr, 0, false};
+            while (ptr != last && *ptr == '0') ++ptr;
+            if (!std::is_constant_evaluated() && std::endian::native == std::endian::little) {
+                if (base == 10) {
+                    for (int digits = 0; last - ptr >= 8;) {
+                        uint64_t x = loadEight(ptr);
+                        int count = leadingRun(bytesBetween(x, '0' - 1, '9' + 1));
+                        count = std::min(count, 19 - digits);
+                        if (!count) break;
+                        result.value = result.value * powersOf10[count] + parseEightDecimal(alignDigits(x, count));
+                        ptr += count;
+                        digits += count;
+                        if (count < 8) break;
+                    }
+                } else if (base == 16) {
+                    for (int digits = 0; last - ptr >= 8;) {
+                        uint64_t x = loadEight(ptr);
+                        int count = leadingRun(bytesBetween(x, '0' - 1, '9' + 1) |
+                            bytesBetween(x, 'A' - 1, 'F' + 1) | bytesBetween(x, 'a' - 1, 'f' + 1));
+                        count = std::min(count, 16 - digits);
+                        if (!count) break;
+                        result.value = (result.value << 4 * count) | parseEightHex(alignDigits(x, count));
+                        ptr += count;
+                        digits += count;
+                        if (count < 8) break;
+                    }
+                }
+            }
+            for (unsigned digit; ptr != last && (digit = digitValue(*ptr)) < base; ++ptr) {
+                // Below 2^58 no base up to 36 can overflow.
+                if (!(result.value >> 58)) {
+                    result.value = result.value * base + digit;
+                } else {
+                    result.overflow |= __builtin_mul_overflow(result.value, (uint64_t)base, &result.value);
+                    result.overflow |= __builtin_add_overflow(result.value, (uint64_t)digit, &result.value);
+                }
+            }
+            result.ptr = ptr;
+            return result;
+        }
+    };
+
+    /* Parses an integer from [first, last) in the manner of std::from_chars, with an optional minus sign for signed types.
+        Base 0 follows the prefix as ston does, 0x or 0X for hexadecimal, 0b or 0B for binary and 0 for octal.
+        Returns the end of the number. If there is none the error is std::errc::invalid_argument,
+            if it does not fit T the error is std::errc::result_out_of_range, either way value is unchanged.
+    */
+    template <std::integral T>
+    constexpr std::from_chars_result ston(const char *first, const char *last, T &value, int base = 0) {
+        const char *ptr = first;
+        bool negative = false;
+        if constexpr (std::is_signed<T>::value) {
+            if (ptr != last && *ptr == '-') {
+                negative = true;
+                ++ptr;
+            }
+        }
+        if (!base) {
+            base = 10;
+            if (ptr != last && *ptr == '0') {
+                base = 8;
+                if (last - ptr >= 3) {
+                    char prefix = ptr[1] | 0x20;
+                    if (prefix == 'x' && impl::digitValue(ptr[2]) < 16) {
+                        base = 16;
+                        ptr += 2;
+                    } else if (prefix == 'b' && impl::digitValue(ptr[2]) < 2) {
+                        base = 2;
+                        ptr += 2;
+                    }
+                }
+            }
+        }
+        if (ptr == last || impl::digitValue(*ptr) >= (unsigned)base)
+            return {first, std::errc::invalid_argument};
+        impl::magnitude result = impl::parseMagnitude(ptr, last, base);
+        using U = typename std::make_unsigned<T>::type;
+        uint64_t limit = (uint64_t)std::numeric_limits<T>::max() + negative;
+        if (result.overflow || result.value > limit)
+            return {result.ptr, std::errc::result_out_of_range};
+        value = (T)(negative ? (U)(0 - result.value) : (U)result.value);
+        return {result.ptr, std::errc()};
+    }
+
+    template <class OutputIt>
+    struct parse_many_result {
+        const char *ptr;
+        std::errc ec;
+        OutputIt out;
+    };
+
+    /* Parses integers separated by a delimiter from [first, last) with ston and writes them to out.
+        A delimiter may end the input, anything else between numbers is an error.
+        Returns where parsing stopped, the error of the number that failed, if any, and the end of the output.
+    */
+    template <std::integral T, class OutputIt>
+    constexpr parse_many_result<OutputIt> parse_many(const char *first, const char *last, char delimiter, OutputIt out, int base = 0) {
+        while (first != last) {
+            T value;
+            auto result = ston(first, last, value, base);
+            if (result.ec != std::errc())
+                return {result.ptr, result.ec, out};
+            *out++ = value;
+            first = result.ptr;
+            if (first != last) {
+                if (*first != delimiter)
+                    return {first, std::errc::invalid_argument, out};
+                ++first;
+            }
+        }
+        return {first, std::errc(), out};
+    }
+    /* Parses a floating point number from [first, last) in the manner of std::from_chars with the general format,
+        without depending on the locale. The nearest float is found with the Eisel-Lemire algorithm,
+            numbers with more than 19 significant digits that it cannot settle fall back to std::from_chars.
+        Returns the end of the number, or std::errc::result_out_of_range and value unchanged
+            if it overflows or underflows to zero.
+    */
+    std::from_chars_result parse_float(const char *first, const char *last, double &value);
+    std::from_chars_result parse_float(const char *first, const char *last, float &value);
+
+    /* Writes the shortest text that parses back to the same value, in the format of std::to_chars without a format.
+        Digits are found with the Schubfach algorithm. Returns last and std::errc::value_too_large if the text does not fit.
+    */
+    std::to_chars_result format_float(char *first, char *last, double value);
+    std::to_chars_result format_float(char *first, char *last, float value);
 };
 
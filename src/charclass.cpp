@@ -0,0 +1,46 @@
+#include <ktu/charclass.hpp>
+#include <ktu/simd.hpp>
+
+namespace {
+    using ktu::simd::block16;
+
+    /* Skips bytes whose class intersects cls, classify must produce the same set for a whole block. */
+    template <uint8_t cls, typename Classify>
+    inline const char *scan(const char *ptr, const char *last, Classify classify) {
+        while ((size_t)(last - ptr) >= block16::width) {
+            uint32_t miss = ~classify(block16(ptr)) & 0xFFFF;
+            if (miss)
+                return ptr + std::countr_zero(miss);
+            ptr += block16::width;
+        }
+        while (ptr < last && ktu::charclass::is(*ptr, cls))
+            ++ptr;
+        return ptr;
+    }
+};
+
+const char *ktu::scanVariable(const char *ptr, const char *last) {
+    if (ptr >= last || !isVariableStart(*ptr))
+        return ptr;
+    return scan<charclass::variable>(ptr + 1, last, [](const block16 &b) {
+        return b.in('a', 'z') | b.in('A', 'Z') | b.in('0', '9') | b.eq('_');
+    });
+}
+
+const char *ktu::scanBin(const char *ptr, const char *last) {
+    return scan<charclass::bin>(ptr, last, [](const block16 &b) {return b.in('0', '1');});
+}
+const char *ktu::scanOct(const char *ptr, const char *last) {
+    return scan<charclass::oct>(ptr, last, [](const block16 &b) {return b.in('0', '7');});
+}
+const char *ktu::scanDec(const char *ptr, const char *last) {
+    return scan<charclass::dec>(ptr, last, [](const block16 &b) {return b.in('0', '9');});
+}
+const char *ktu::scanHex(const char *ptr, const char *last) {
+    return scan<charclass::hex>(ptr, last, [](const block16 &b) {
+        return b.in('0', '9') | b.in('a', 'f') | b.in('A', 'F');
+    });
+}
+const char *ktu::scanSpace(const char *ptr, const char *last) {
+    return scan<charclass::space>(ptr, last, [](const block16 &b) {return b.in('\t', '\r') | b.eq(' ');});
+}
@@ -0,0 +1,43 @@
+#include <ktu/csv.hpp>
+
+void ktu::csv::tokenizer::index() {
+    const uint8_t *ptr = first + indexed;
+    size_t remaining = last - ptr;
+    simd::block b = (remaining >= simd::width) ? simd::block(ptr) : simd::block::partial(ptr, remaining);
+    uint64_t valid = simd::low_bits(remaining);
+
+    uint64_t quoted = 0;
+    if (quote) {
+        quoted = simd::prefix_xor(b.eq(quote) & valid) ^ inside;
+        inside = (uint64_t)((int64_t)quoted >> 63);
+    }
+    structurals = (b.eq(delimiter) | b.eq('\n')) & ~quoted & valid;
+    indexed += simd::width;
+}
+
+bool ktu::csv::tokenizer::finish() {
+    if (start >= last && !trailing)
+        return false;
+    emit(last, true);
+    start = last;
+    trailing = false;
+    return true;
+}
+
+std::string ktu::csv::unescape(const view &data, char quote) {
+    std::string result;
+    result.reserve(data.size());
+    const char *ptr = data.begin<char>(), *end = data.end<char>();
+    while (ptr < end) {
+        const char *next = (const char*)memchr(ptr, quote, end - ptr);
+        if (!next) {
+            result.append(ptr, end);
+            break;
+        }
+        result.append(ptr, next + 1);
+        ptr = next + 1;
+        if (ptr < end && *ptr == quote)
+            ++ptr;
+    }
+    return result;
+}
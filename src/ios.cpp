@@ -1,4 +1,9 @@
 #include <ktu/ios.hpp>
+#include <ktu/simd.hpp>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <string_view>
 
 // void ktu::bin(std::ostream &os, uint8_t value) {
 //     for (int j = 0; j < 8; value <<= 1, j++) {
@@ -24,36 +29,183 @@
 
 
 
-std::ostream &ktu::io::bits(std::ostream &os, unsigned long value) {
-    unsigned long mask = 1ULL << ((sizeof(unsigned long) << 3ULL) - 1ULL);
-    int i = ((sizeof(unsigned long) << 3ULL)) - 1;
-    while ((mask > 1)&& !(value & mask)) {mask >>= 1; i--;}
+namespace {
+    /* Two characters for every value of a byte in hexadecimal, lowercase and then uppercase. */
+    constexpr std::array<std::array<char[2], 256>, 2> hexPairs = [] {
+        std::array<std::array<char[2], 256>, 2> result = {};
+        for (unsigned value = 0; value < 256; value++) {
+            result[0][value][0] = "0123456789abcdef"[value >> 4];
+            result[0][value][1] = "0123456789abcdef"[value & 0xF];
+            result[1][value][0] = "0123456789ABCDEF"[value >> 4];
+            result[1][value][1] = "0123456789ABCDEF"[value & 0xF];
+        }
+        return result;
+    }();
+
+    /* Two characters for every value of six bits in octal. */
+    constexpr std::array<char[2], 64> octalPairs = [] {
+        std::array<char[2], 64> result = {};
+        for (unsigned value = 0; value < 64; value++) {
+            result[value][0] = '0' + (value >> 3);
+            result[value][1] = '0' + (value & 7);
+        }
+        return result;
+    }();
+
+    /* Two characters for every value below one hundred. */
+    constexpr std::array<char[2], 100> decimalPairs = [] {
+        std::array<char[2], 100> result = {};
+        for (unsigned value = 0; value < 100; value++) {
+            result[value][0] = '0' + value / 10;
+            result[value][1] = '0' + value % 10;
+        }
+        return result;
+    }();
 
-    os.width(std::max(os.width() - i, (std::streamsize)0));
-    os.fill();
+    /* Eight characters for every value of a byte in binary. */
+    constexpr std::array<char[8], 256> bitOctets = [] {
+        std::array<char[8], 256> result = {};
+        for (unsigned value = 0; value < 256; value++)
+            for (unsigned i = 0; i < 8; i++)
+                result[value][i] = '0' + ((value >> (7 - i)) & 1);
+        return result;
+    }();
 
+    constexpr std::array<unsigned long, 20> powersOf10 = [] {
+        std::array<unsigned long, 20> result = {};
+        unsigned long power = 1;
+        for (auto &value : result) {
+            value = power;
+            power *= 10;
+        }
+        return result;
+    }();
 
-    for (;mask; mask >>= 1) {
-        os << !!(value & mask);
+    /* Amount of decimal digits, estimated from the bit width as log10(2) ~ 1233 / 4096. */
+    inline int decimalDigits(unsigned long value) {
+        int estimate = (std::bit_width(value | 1) * 1233) >> 12;
+        return estimate + ((value | 1) >= powersOf10[estimate]);
     }
-    return os;
+
+    /* Reserves digits characters at first, or fails when they do not fit. */
+    inline bool fits(char *first, char *last, int digits, std::to_chars_result &result) {
+        if (last - first < digits) {
+            result = {last, std::errc::value_too_large};
+            return false;
+        }
+        result = {first + digits, std::errc()};
+        return true;
+    }
+
+    /* Writes text to a stream, padded to its width with its fill character.
+        Internal adjustment places the padding between the prefix and the digits.
+    */
+    std::ostream &padded(std::ostream &os, std::string_view prefix, const char *first, const char *last) {
+        std::ostream::sentry sentry(os);
+        if (!sentry) return os;
+        std::streamsize size = prefix.size() + (last - first);
+        std::streamsize padding = std::max(os.width() - size, (std::streamsize)0);
+        std::ios_base::fmtflags adjust = os.flags() & std::ios_base::adjustfield;
+        os.width(0);
+        auto fill = [&] {
+            char chunk[64];
+            memset(chunk, os.fill(), sizeof(chunk));
+            for (std::streamsize count; padding; padding -= count) {
+                count = std::min(padding, (std::streamsize)sizeof(chunk));
+                os.rdbuf()->sputn(chunk, count);
+            }
+        };
+        if (adjust != std::ios_base::left && adjust != std::ios_base::internal)
+            fill();
+        os.rdbuf()->sputn(prefix.data(), prefix.size());
+        if (adjust == std::ios_base::internal)
+            fill();
+        if (os.rdbuf()->sputn(first, last - first) != last - first)
+            os.setstate(std::ios_base::badbit);
+        fill();
+        return os;
+    }
+};
+
+std::to_chars_result ktu::io::bits(char *first, char *last, unsigned long value) {
+    int digits = std::bit_width(value | 1);
+    std::to_chars_result result;
+    if (!fits(first, last, digits, result)) return result;
+    char *ptr = result.ptr;
+    for (; digits >= 8; digits -= 8, value >>= 8)
+        memcpy(ptr -= 8, bitOctets[value & 0xFF], 8);
+    if (digits)
+        memcpy(first, bitOctets[value] + 8 - digits, digits);
+    return result;
+}
+
+std::to_chars_result ktu::io::octal(char *first, char *last, unsigned long value) {
+    int digits = (std::bit_width(value | 1) + 2) / 3;
+    std::to_chars_result result;
+    if (!fits(first, last, digits, result)) return result;
+    char *ptr = result.ptr;
+    for (; digits >= 2; digits -= 2, value >>= 6)
+        memcpy(ptr -= 2, octalPairs[value & 63], 2);
+    if (digits)
+        *first = '0' + value;
+    return result;
+}
+
+std::to_chars_result ktu::io::decimal(char *first, char *last, unsigned long value) {
+    int digits = decimalDigits(value);
+    std::to_chars_result result;
+    if (!fits(first, last, digits, result)) return result;
+    char *ptr = result.ptr;
+    for (; value >= 100; value /= 100)
+        memcpy(ptr -= 2, decimalPairs[value % 100], 2);
+    if (value >= 10)
+        memcpy(first, decimalPairs[value], 2);
+    else
+        *first = '0' + value;
+    return result;
+}
+
+std::to_chars_result ktu::io::hexadecimal(char *first, char *last, unsigned long value, bool uppercase) {
+    int digits = (std::bit_width(value | 1) + 3) / 4;
+    std::to_chars_result result;
+    if (!fits(first, last, digits, result)) return result;
+    auto &pairs = hexPairs[uppercase];
+    char *ptr = result.ptr;
+    for (; digits >= 2; digits -= 2, value >>= 8)
+        memcpy(ptr -= 2, pairs[value & 0xFF], 2);
+    if (digits)
+        *first = pairs[value][1];
+    return result;
+}
+
+std::ostream &ktu::io::bits(std::ostream &os, unsigned long value) {
+    char text[64];
+    return padded(os, {}, text, bits(text, std::end(text), value).ptr);
 }
 
 std::ostream &ktu::io::octal(std::ostream &os, unsigned long value) {
-    return os << std::oct << value;
+    // The base of octal is a leading zero, which is not separated from the digits by internal adjustment.
+    char text[23] = {'0'};
+    char *first = text + (value && (os.flags() & std::ios_base::showbase));
+    return padded(os, {}, text, octal(first, std::end(text), value).ptr);
 }
 
 std::ostream &ktu::io::decimal(std::ostream &os, unsigned long value) {
-    return os << std::dec << value;
+    char text[20];
+    return padded(os, {}, text, decimal(text, std::end(text), value).ptr);
 }
 
 std::ostream &ktu::io::hexadecimal(std::ostream &os, unsigned long value) {
-    return os << std::hex << value;
+    char text[16];
+    bool uppercase = os.flags() & std::ios_base::uppercase;
+    bool prefix = value && (os.flags() & std::ios_base::showbase);
+    return padded(os, prefix ? (uppercase ? "0X" : "0x") : "", text, hexadecimal(text, std::end(text), value, uppercase).ptr);
 }
 
 
 int const ktu::buf_io::manipGroupingId = std::ios_base::xalloc();
 int const ktu::buf_io::manipFlagId = std::ios_base::xalloc();
+int const ktu::buf_io::manipThreadsId = std::ios_base::xalloc();
 
 std::ostream &ktu::buf_io::bin(std::ostream &os) {
     os.iword(manipFlagId) &= ~(fmtflags::basefield);
@@ -182,244 +334,683 @@ void ktu::write(const std::filesystem::path &path, char *first, char *last) {
     std::copy(first, last, std::ostream_iterator<char>(f));
 }
 */
-#include <iterator>
+#include <cstdio>
+#include <vector>
+#include <thread>
+#include <cerrno>
+#include <unistd.h>
+#if defined(__GLIBCXX__)
+#include <ext/stdio_sync_filebuf.h>
+#endif
 
-std::ostream &ktu::operator<<(std::ostream &os, const buf_io::output &obj) {
-    if (!obj.size) return os;
-    long flags = os.iword(ktu::buf_io::manipFlagId);
-    if (!(flags & ktu::buf_io::fmtflags::fmt)) {
-        char buffer [256 * 1024];
-        os.rdbuf()->pubsetbuf(buffer, sizeof(buffer));
-        std::copy((const char*)obj.ptr, (const char*)obj.ptr + obj.size, std::ostream_iterator<char>(os));
-        return os;
+namespace {
+    using namespace ktu;
+    using fmtflags = buf_io::fmtflags;
+
+    /* Text of a byte value in one base. */
+    struct digits {
+        char text[8];
+        uint8_t size;
+    };
+    using digit_table = std::array<digits, 256>;
+
+    /* Digits of every byte value, padded with zeros up to width. */
+    constexpr digit_table makeDigits(unsigned base, unsigned width) {
+        digit_table result = {};
+        for (unsigned value = 0; value < 256; value++) {
+            char reversed[8] = {};
+            unsigned size = 0, remaining = value;
+            do {
+                reversed[size++] = "0123456789ABCDEF"[remaining % base];
+                remaining /= base;
+            } while (remaining);
+            while (size < width)
+                reversed[size++] = '0';
+            for (unsigned i = 0; i < size; i++)
+                result[value].text[i] = reversed[size - 1 - i];
+            result[value].size = size;
+        }
+        return result;
     }
-    if (flags & ktu::buf_io::fmtflags::fmtinfo) {
-        os << "[[";
-        switch (flags & ktu::buf_io::fmtflags::encodingfield) {
-            case ktu::buf_io::fmtflags::numeric:
-                os << "numeric";
-                break;
-            case ktu::buf_io::fmtflags::ascii:
-                os << "ascii";
-                break;
-            case ktu::buf_io::fmtflags::latin_1:
-                os << "latin_1";
-                break;
-            case ktu::buf_io::fmtflags::utf_8:
-                os << "utf_8";
-                break;
-            case ktu::buf_io::fmtflags::utf_16le:
-                os << "utf_16le";
-                break;
-            case ktu::buf_io::fmtflags::utf_16be:
-                os << "utf_16be";
-                break;
-            case ktu::buf_io::fmtflags::utf_32le:
-                os << "utf_32le";
-                break;
-            case ktu::buf_io::fmtflags::utf_32be:
-                os << "utf_32be";
-                break;
+
+    /* Indexed by the base field, then by whether zero filling is disabled. */
+    constexpr digit_table digitTables[4][2] = {
+        {makeDigits(16, 2), makeDigits(16, 0)},
+        {makeDigits(10, 3), makeDigits(10, 0)},
+        {makeDigits(8, 3),  makeDigits(8, 0)},
+        {makeDigits(2, 8),  makeDigits(2, 0)}
+    };
+
+    struct streamOutput {
+        std::ostream &os;
+        inline void write(const char *ptr, size_t size) {
+            os.write(ptr, size);
         }
-        os << ' ';
-        switch (flags & ktu::buf_io::fmtflags::basefield) {
-            case ktu::buf_io::fmtflags::bin:
-                os << "bin";
-                break;
-            case ktu::buf_io::fmtflags::oct:
-                os << "oct";
-                break;
-            case ktu::buf_io::fmtflags::dec:
-                os << "dec";
-                break;
-            case ktu::buf_io::fmtflags::hex:
-                os << "hex";
-                break;
+    };
+
+    struct callbackOutput {
+        void (*callback)(void *context, const char *ptr, size_t size);
+        void *context;
+        inline void write(const char *ptr, size_t size) {
+            callback(context, ptr, size);
+        }
+    };
+
+    /* Not a codepoint, returned for a sequence cut off by the end of the input. */
+    constexpr uint32_t incomplete = 0xFFFFFFFF;
+
+    /* Decodes a codepoint without reading past end.
+        A sequence that needs bytes past end is incomplete, ptr is left at end so its bytes are output numerically.
+    */
+    inline uint32_t readBounded(uint32_t (*read)(const void**), const uint8_t *&ptr, const uint8_t *end) {
+        if (end - ptr >= 4)
+            return read((const void**)&ptr);
+        // Sequences are at most four bytes, so the decoder never reads past the padding.
+        uint8_t padded[8] = {};
+        size_t remaining = end - ptr;
+        memcpy(padded, ptr, remaining);
+        const uint8_t *tmp = padded;
+        uint32_t codepoint = read((const void**)&tmp);
+        if ((size_t)(tmp - padded) > remaining) {
+            ptr = end;
+            return incomplete;
         }
-        os << "]]";
+        ptr += tmp - padded;
+        return codepoint;
     }
 
-    std::ios tmpState(nullptr);
-    tmpState.copyfmt(os);
-    
-    unsigned long grouping = os.iword(ktu::buf_io::manipGroupingId);
-    int width;
-    std::ostream &(*formatted)(std::ostream&, unsigned long);
-    bool nozfill = (flags & ktu::buf_io::fmtflags::nozfill);
-    switch (flags & ktu::buf_io::fmtflags::basefield) {
-        case ktu::buf_io::fmtflags::bin:
-            width = (nozfill) ? 0 : 8;
-            formatted = &ktu::io::bits;
-            break;
-        case ktu::buf_io::fmtflags::oct:
-            width = (nozfill) ? 0 : 3;
-            formatted = &ktu::io::octal;
-            break;
-        case ktu::buf_io::fmtflags::dec:
-            width = (nozfill) ? 0 : 3;
-            formatted = &ktu::io::decimal;
-            break;
-        case ktu::buf_io::fmtflags::hex:
-            width = (nozfill) ? 0 : 2;
-            os << std::uppercase;
-            formatted = &ktu::io::hexadecimal;
-            break;
+    /* Printable ascii up to last that is written without an escape. */
+    inline bool plainAscii(uint32_t value, uint8_t last) {
+        return 0x1F < value && value <= last && value != '[' && value != '\\';
+    }
+
+    /* Returns how many code units of stride bytes starting at ptr hold plain ascii, see plainAscii.
+        offset is the byte of each unit holding the character, all other bytes of the unit must be zero.
+        Input is classified 64 bytes at a time.
+    */
+    size_t asciiUnits(const uint8_t *ptr, const uint8_t *end, unsigned stride, unsigned offset, uint8_t last) {
+        // Bits of the first byte of every unit.
+        const uint64_t lanes = (stride == 1) ? ~uint64_t(0) : (stride == 2) ? 0x5555555555555555 : 0x1111111111111111;
+        size_t count = 0;
+        while (ptr < end) {
+            size_t remaining = end - ptr;
+            simd::block b = (remaining >= simd::width) ? simd::block(ptr) : simd::block::partial(ptr, remaining);
+            uint64_t valid = simd::low_bits(remaining);
+            uint64_t plain = b.in(0x20, last) & ~b.eq('[') & ~b.eq('\\') & valid;
+            uint64_t match = plain >> offset;
+            if (stride != 1) {
+                uint64_t zero = b.eq(0) & valid;
+                for (unsigned i = 0; i < stride; i++)
+                    if (i != offset)
+                        match &= zero >> i;
+            }
+            uint64_t miss = ~match & lanes;
+            if (miss)
+                return count + std::countr_zero(miss) / stride;
+            count += simd::width / stride;
+            ptr += simd::width;
+        }
+        return count;
     }
-    
-
-    const uint8_t * cur = (const uint8_t*)obj.ptr, *end = cur + obj.size;
-    switch (flags & ktu::buf_io::fmtflags::encodingfield) {
-        case ktu::buf_io::fmtflags::numeric: {
-            int j = 0;
-            numeric_format_loop:
-                os << std::setfill('0') << std::setw(width);
-                formatted(os, *cur);
-                if (++cur != end) {
-                    if (++j == grouping) {
-                        os << ' ';
-                        j = 0;
-                    } else if (nozfill) {
-                        os << ':';
+
+    /* Formats bytes into a fixed size block, handing every full block to the output in a single write.
+        Numbers are copied out of precomputed digit tables.
+        A bracketed run left open by render is continued by the next call and closed by finish.
+    */
+    template <class Output>
+    class renderer {
+        public:
+            static constexpr size_t block_size = 64 * 1024;
+
+            renderer(Output &out, long flags, unsigned long grouping) :
+                out(out), flags(flags), grouping(grouping),
+                table(digitTables[flags & fmtflags::basefield][!!(flags & fmtflags::nozfill)]),
+                nozfill(flags & fmtflags::nozfill) {}
+
+            void info();
+            void render(const uint8_t *cur, const uint8_t *end);
+
+            /* Continues after bytes rendered elsewhere, j is the grouping counter of the last byte written.
+                Only meaningful for the numeric, ascii and latin_1 encodings.
+            */
+            inline void resume(bool open, unsigned long j) {
+                this->open = open;
+                this->j = j;
+                started = true;
+            }
+
+            inline void flush() {
+                if (used)
+                    out.write(block, used);
+                used = 0;
+            }
+            inline void finish() {
+                if (open)
+                    put(']');
+                open = false;
+                flush();
+            }
+
+        private:
+            /* Makes room for size more bytes. */
+            inline void reserve(size_t size) {
+                if (block_size - used < size)
+                    flush();
+            }
+            inline void put(char c) {
+                reserve(1);
+                block[used++] = c;
+            }
+            inline void put(const char *str, size_t size) {
+                reserve(size);
+                memcpy(block + used, str, size);
+                used += size;
+            }
+            inline void number(uint8_t value) {
+                reserve(sizeof(digits::text));
+                memcpy(block + used, table[value].text, sizeof(digits::text));
+                used += table[value].size;
+            }
+            inline void separator(unsigned long &j) {
+                if (++j == grouping) {
+                    put(' ');
+                    j = 0;
+                } else if (nozfill) {
+                    put(':');
+                }
+            }
+            /* Copies count ascii characters, one out of every stride bytes. */
+            inline void text(const uint8_t *ptr, size_t count, unsigned stride, unsigned offset) {
+                while (count) {
+                    if (used == block_size)
+                        flush();
+                    size_t size = std::min(count, block_size - used);
+                    if (stride == 1) {
+                        memcpy(block + used, ptr, size);
+                    } else {
+                        for (size_t i = 0; i < size; i++)
+                            block[used + i] = ptr[i * stride + offset];
                     }
-                    goto numeric_format_loop;
+                    used += size;
+                    ptr += size * stride;
+                    count -= size;
                 }
-            break;
+            }
+            inline void character(uint32_t codepoint) {
+                reserve(5);
+                if (codepoint == '\\' || codepoint == '[')
+                    block[used++] = '\\';
+                used += u8::write(codepoint, block + used);
+            }
+
+            void numeric(const uint8_t *cur, const uint8_t *end);
+            template <class Printable>
+            void bytes(const uint8_t *cur, const uint8_t *end, Printable printable);
+            void unicode(const uint8_t *cur, const uint8_t *end);
+
+            Output &out;
+            long flags;
+            unsigned long grouping;
+            const digit_table &table;
+            bool nozfill;
+            bool started = false;
+            bool open = false;
+            unsigned long j = 0;
+            size_t used = 0;
+            char block[block_size];
+    };
+
+    inline bool printableAscii(uint8_t value) {
+        return 0x1F < value && value < 0x7F;
+    }
+    inline bool printableLatin_1(uint8_t value) {
+        return (0x1F < value && value < 0x7F) || value > 0xA0;
+    }
+
+    template <class Output>
+    void renderer<Output>::info() {
+        static constexpr const char *encodings[] = {
+            "numeric", "ascii", "latin_1", "utf_8", "utf_16le", "utf_16be", "utf_32le", "utf_32be"
+        };
+        static constexpr const char *bases[] = {"hex", "dec", "oct", "bin"};
+        const char *encoding = encodings[(flags & fmtflags::encodingfield) >> 2], *base = bases[flags & fmtflags::basefield];
+        put("[[", 2);
+        put(encoding, strlen(encoding));
+        put(' ');
+        put(base, strlen(base));
+        put("]]", 2);
+    }
+
+    template <class Output>
+    void renderer<Output>::render(const uint8_t *cur, const uint8_t *end) {
+        switch (flags & fmtflags::encodingfield) {
+            case fmtflags::numeric:
+                return numeric(cur, end);
+            case fmtflags::ascii:
+                return bytes(cur, end, printableAscii);
+            case fmtflags::latin_1:
+                return bytes(cur, end, printableLatin_1);
+            default:
+                return unicode(cur, end);
+        }
+    }
+
+    template <class Output>
+    void renderer<Output>::numeric(const uint8_t *cur, const uint8_t *end) {
+        if (cur != end && !started) {
+            number(*cur++);
+            started = true;
+        }
+        for (; cur != end; cur++) {
+            separator(j);
+            number(*cur);
         }
-        case ktu::buf_io::fmtflags::ascii: {
-            uint8_t value = *cur;
-            while (cur != end) {
-                if (0x1F < value && value < 0x7F)
-                    do {
-                        if (value == '\\' || value == '[') os << '\\';
-                        os << value;
-                        value = *(++cur);
-                    } while (cur != end && 0x1F < value && value < 0x7F);
-                else {
-                    int j = 0;
-                    os << '[';
-                    ascii_invalid_loop:
-                        os << std::setfill('0') << std::setw(width);
-                        formatted(os, value);
-                        value = *(++cur);
-                        if (cur != end && (value < 0x20 || value > 0x7E)) {
-                            if (++j == grouping) {
-                                os << ' ';
-                                j = 0;
-                            } else if (nozfill) {
-                                os << ':';
-                            }
-                            goto ascii_invalid_loop;
-                        }
-                    os << ']';
+    }
+
+    template <class Output>
+    template <class Printable>
+    void renderer<Output>::bytes(const uint8_t *cur, const uint8_t *end, Printable printable) {
+        while (cur != end) {
+            if (printable(*cur)) {
+                if (open) {
+                    put(']');
+                    open = false;
                 }
+                do {
+                    if (plainAscii(*cur, 0x7E)) {
+                        size_t count = asciiUnits(cur, end, 1, 0, 0x7E);
+                        text(cur, count, 1, 0);
+                        cur += count;
+                        continue;
+                    }
+                    character(*cur++);
+                } while (cur != end && printable(*cur));
+                continue;
+            }
+            if (!open) {
+                put('[');
+                number(*cur++);
+                open = true;
+                j = 0;
+            }
+            for (; cur != end && !printable(*cur); cur++) {
+                separator(j);
+                number(*cur);
             }
-            break;
         }
-        case ktu::buf_io::fmtflags::latin_1: {
-            uint8_t value = *cur;
-            while (cur != end) {
-                if ((0x1F < value && value < 0x7F) || (value > 0xA0))
-                    do {
-                        char buf[4];
-                        size_t size = ktu::u8::write(value, &buf[0]);
-                        if (value == '\\' || value == '[') os << '\\';
-                        os.write(&buf[0], size);
-                        value = *(++cur);
-                    } while (((0x1F < value && value < 0x7F) || (value > 0xA0)) && cur != end);
-                else {
-                    int j = 0;
-                    os << '[';
-                    latin_1_invalid_loop:
-                        os << std::setfill('0') << std::setw(width);
-                        formatted(os, value);
-                        value = *(++cur);
-                        
-                        if ((value < 0x20 || (value > 0x7E && value < 0xA1)) && cur != end) {
-                            if (++j == grouping) {
-                                os << ' ';
-                                j = 0;
-                            } else if (nozfill) {
-                                os << ':';
-                            }
-                            goto latin_1_invalid_loop;
-                        }
-                    os << ']';
+    }
+
+    template <class Output>
+    void renderer<Output>::unicode(const uint8_t *cur, const uint8_t *end) {
+        uint32_t (*read)(const void**);
+        // Size of a code unit and the byte holding an ascii character within it.
+        unsigned stride, offset = 0;
+        switch (flags & fmtflags::encodingfield) {
+            case fmtflags::utf_8:
+                read = u8::ptr::read_ref;
+                stride = 1;
+                break;
+            case fmtflags::utf_16le:
+                read = u16::ptr::read_ref_le;
+                stride = 2;
+                break;
+            case fmtflags::utf_16be:
+                read = u16::ptr::read_ref_be;
+                stride = 2;
+                offset = 1;
+                break;
+            case fmtflags::utf_32le:
+                read = u32::ptr::read_ref_le;
+                stride = 4;
+                break;
+            default:
+                read = u32::ptr::read_ref_be;
+                stride = 4;
+                offset = 3;
+                break;
+        }
+        auto printable = [](uint32_t codepoint) {return validUnicode(codepoint) && 0x1F < codepoint;};
+        // cur is the start of the current codepoint and next its end.
+        const uint8_t *next = cur;
+        uint32_t codepoint = readBounded(read, next, end);
+        while (cur < end) {
+            if (printable(codepoint)) {
+                do {
+                    // Every unit of an ascii run is a codepoint of its own, so it is copied without decoding.
+                    // A unit cut off by the end of the input is left to the decoder.
+                    size_t count;
+                    if (plainAscii(codepoint, 0x7F) && (count = asciiUnits(cur, end, stride, offset, 0x7F))) {
+                        text(cur, count, stride, offset);
+                        next = cur += count * stride;
+                        codepoint = readBounded(read, next, end);
+                        continue;
+                    }
+                    cur = next;
+                    character(codepoint);
+                    codepoint = readBounded(read, next, end);
+                } while (printable(codepoint) && cur < end);
+                continue;
+            }
+            // Invalid codepoints are written as their bytes, an opening bracket continues the run.
+            unsigned long j = 0;
+            put('[');
+            while (true) {
+                if (cur != next) {
+                    number(*cur++);
+                    while (cur != next && cur != end) {
+                        separator(j);
+                        number(*cur++);
+                    }
                 }
+                codepoint = readBounded(read, next, end);
+                if ((printable(codepoint) && codepoint != '[') || cur >= end)
+                    break;
+                separator(j);
             }
-            break;
+            put(']');
         }
-        default: {
-            uint32_t (*read)(const void**);
-            switch (flags & ktu::buf_io::fmtflags::encodingfield) {
-                case ktu::buf_io::fmtflags::utf_8:
-                    read = ktu::u8::ptr::read_ref;
-                    break;
-                case ktu::buf_io::fmtflags::utf_16le:
-                    read = ktu::u16::ptr::read_ref_le;
-                    break;
-                case ktu::buf_io::fmtflags::utf_16be:
-                    read = ktu::u16::ptr::read_ref_be;
+    }
+
+    /* Buffers smaller than this are always rendered on the calling thread. */
+    constexpr size_t parallel_threshold = 1024 * 1024;
+    /* Size each worker renders at a time. */
+    constexpr size_t piece_size = 1024 * 1024;
+
+    struct stringOutput {
+        std::string &str;
+        inline void write(const char *ptr, size_t size) {
+            str.append(ptr, size);
+        }
+    };
+
+    /* A range of the input and the renderer state at its start. */
+    struct piece {
+        const uint8_t *begin;
+        const uint8_t *end;
+        bool resume;
+        bool open;
+        unsigned long j;
+    };
+
+    /* Whether a range of unicode text may start at ptr.
+        The codepoint before ptr must be known to end there and be printable, other than an opening bracket,
+            so no codepoint or bracketed run crosses ptr.
+    */
+    bool unicodeCut(long flags, const uint8_t *first, const uint8_t *ptr) {
+        auto printable = [](uint32_t codepoint) {return 0x1F < codepoint && codepoint != '[' && validUnicode(codepoint);};
+        if (ptr - first < 4)
+            return false;
+        switch (flags & fmtflags::encodingfield) {
+            case fmtflags::utf_8:
+                // Sequences are at most four bytes, so after four ascii bytes the last one stands alone.
+                return (ptr[-4] | ptr[-3] | ptr[-2] | ptr[-1]) < 0x80 && printable(ptr[-1]);
+            case fmtflags::utf_16le:
+            case fmtflags::utf_16be: {
+                if ((ptr - first) % 2)
+                    return false;
+                auto unit = [flags](const uint8_t *p) -> uint16_t {
+                    return ((flags & fmtflags::encodingfield) == fmtflags::utf_16be) ? (p[0] << 8) | p[1] : (p[1] << 8) | p[0];
+                };
+                uint16_t before = unit(ptr - 4), last = unit(ptr - 2);
+                auto high = [](uint16_t unit) {return 0xD800 <= unit && unit < 0xDC00;};
+                return !high(before) && !high(last) && printable((0xDC00 <= last && last < 0xE000) ? 0xFFFD : last);
+            }
+            default:
+                if ((ptr - first) % 4)
+                    return false;
+                const uint8_t *p = ptr - 4;
+                return printable(((flags & fmtflags::encodingfield) == fmtflags::utf_32be) ?
+                    ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3] :
+                    ((uint32_t)p[3] << 24) | (p[2] << 16) | (p[1] << 8) | p[0]
+                );
+        }
+    }
+
+    /* Splits the input into pieces of about piece_size bytes that can be rendered independently. */
+    std::vector<piece> split(long flags, unsigned long grouping, const uint8_t *first, const uint8_t *last) {
+        std::vector<piece> pieces;
+        pieces.push_back({first, last, false, false, 0});
+        const uint8_t *runStart = first;
+        for (const uint8_t *nominal = first + piece_size; nominal < last; nominal += piece_size) {
+            piece &previous = pieces.back();
+            const uint8_t *cut = nominal;
+            piece next = {cut, last, true, false, 0};
+            switch (flags & fmtflags::encodingfield) {
+                case fmtflags::numeric:
+                    next.j = (grouping) ? (cut - first - 1) % grouping : 0;
                     break;
-                case ktu::buf_io::fmtflags::utf_32le:
-                    read = ktu::u32::ptr::read_ref_le;
+                case fmtflags::ascii:
+                case fmtflags::latin_1: {
+                    auto printable = ((flags & fmtflags::encodingfield) == fmtflags::ascii) ? printableAscii : printableLatin_1;
+                    // Find where the bracketed run containing the cut started, if any.
+                    const uint8_t *ptr = cut;
+                    while (ptr > previous.begin && !printable(ptr[-1]))
+                        --ptr;
+                    if (ptr > previous.begin || !previous.open)
+                        runStart = ptr;
+                    next.open = !printable(cut[-1]);
+                    next.j = (grouping && next.open) ? (cut - runStart - 1) % grouping : 0;
                     break;
-                case ktu::buf_io::fmtflags::utf_32be:
-                    read = ktu::u32::ptr::read_ref_be;
+                }
+                default: {
+                    const uint8_t *limit = std::min(nominal + piece_size, last);
+                    while (cut < limit && !unicodeCut(flags, first, cut))
+                        ++cut;
+                    if (cut == limit)
+                        continue;
+                    next.begin = cut;
+                    next.resume = false;
                     break;
+                }
             }
-            char buf[4];
-            const uint8_t *tmp = cur;
-            uint32_t codepoint = read((const void**)&tmp);
-            size_t size;
-            while (cur < end) {
-                if (ktu::validUnicode(codepoint) && 0x1F < codepoint)
-                    do {
-                        cur = tmp;
-                        size = ktu::u8::write(codepoint, &buf[0]);
-                        if (codepoint == '\\' || codepoint == '[') os << '\\';
-                        os.write(&buf[0], size);
-                        codepoint = read((const void**)&tmp);
-                    } while (ktu::validUnicode(codepoint) && 0x1F < codepoint && cur < end);
-                else {
-                    int j = 0;
-                    os << '[';
-                    unicode_invalid_loop:
-                        if (cur != tmp) {
-                            unicode_numeric_format_loop:
-                                os << std::setfill('0') << std::setw(width);
-                                formatted(os, *cur++);
-                                if (cur != tmp && cur != end) {
-                                    if (++j == grouping) {
-                                        os << ' ';
-                                        j = 0;
-                                    } else if (nozfill) {
-                                        os << ':';
-                                    }
-                                    goto unicode_numeric_format_loop;
-                                }
-                        }
-                        codepoint = read((const void**)&tmp);
-                        if ((!ktu::validUnicode(codepoint) || codepoint < 0x20 || codepoint == '[') && cur < end) {
-                            if (++j == grouping) {
-                                os << ' ';
-                                j = 0;
-                            } else if (nozfill) {
-                                os << ':';
-                            }
-                            goto unicode_invalid_loop;
-                        }
-                    os << ']';
+            previous.end = cut;
+            pieces.push_back(next);
+        }
+        return pieces;
+    }
+
+    void renderParallel(std::ostream &os, long flags, unsigned long grouping, unsigned threads, const uint8_t *first, const uint8_t *last) {
+        std::vector<piece> pieces = split(flags, grouping, first, last);
+        std::vector<std::string> results(threads);
+        auto work = [&](size_t index, std::string &result) {
+            const piece &p = pieces[index];
+            result.clear();
+            stringOutput out {result};
+            renderer<stringOutput> format(out, flags, grouping);
+            if (p.resume)
+                format.resume(p.open, p.j);
+            if (index == 0 && (flags & fmtflags::fmtinfo))
+                format.info();
+            format.render(p.begin, p.end);
+            if (index + 1 == pieces.size())
+                format.finish();
+            else
+                format.flush();
+        };
+        for (size_t index = 0; index < pieces.size(); index += threads) {
+            size_t count = std::min<size_t>(threads, pieces.size() - index);
+            std::vector<std::thread> workers;
+            for (size_t i = 1; i < count; i++)
+                workers.emplace_back(work, index + i, std::ref(results[i]));
+            work(index, results[0]);
+            for (auto &worker : workers)
+                worker.join();
+            for (size_t i = 0; i < count; i++)
+                os.write(results[i].data(), results[i].size());
+        }
+    }
+
+    /* Writes straight to a file descriptor, retrying interrupted and partial writes. */
+    struct fdOutput {
+        int fd;
+        bool failed = false;
+        void write(const char *ptr, size_t size) {
+            while (size && !failed) {
+                ssize_t written = ::write(fd, ptr, size);
+                if (written < 0) {
+                    failed = (errno != EINTR);
+                    continue;
                 }
-                
+                ptr += written;
+                size -= written;
+            }
+        }
+    };
+
+    /* Raw writes at least this large bypass the stream buffer when it writes to a C file. */
+    constexpr size_t direct_threshold = 64 * 1024;
+
+    /* The C file a stream writes through, or nullptr if it is not known.
+        This is how std::cout, std::cerr and std::clog are backed while synchronized with stdio.
+    */
+    FILE *streamFile(std::ostream &os) {
+        #if defined(__GLIBCXX__)
+            if (auto *buf = dynamic_cast<__gnu_cxx::stdio_sync_filebuf<char>*>(os.rdbuf()))
+                return buf->file();
+        #endif
+        return nullptr;
+    }
+
+    /* Writes the bytes unformatted, straight to the file descriptor behind the stream when there is one. */
+    void writeRaw(std::ostream &os, const char *ptr, size_t size) {
+        FILE *file = size >= direct_threshold ? streamFile(os) : nullptr;
+        int fd = file ? fileno(file) : -1;
+        if (fd < 0) {
+            os.write(ptr, size);
+            return;
+        }
+        std::ostream::sentry sentry(os);
+        if (!sentry) return;
+        if (os.rdbuf()->pubsync() == -1 || std::fflush(file) == EOF) {
+            os.setstate(std::ios_base::badbit);
+            return;
+        }
+        fdOutput out {fd};
+        out.write(ptr, size);
+        if (out.failed)
+            os.setstate(std::ios_base::badbit);
+    }
+
+    /* Writes an offset with at least 8 hexadecimal digits. */
+    inline char *hexOffset(char *out, uint64_t offset) {
+        int digits = std::max(8, (int)(std::bit_width(offset) + 3) / 4);
+        for (int i = digits - 1; i >= 0; i--, offset >>= 4)
+            out[i] = "0123456789abcdef"[offset & 0xF];
+        return out + digits;
+    }
+
+    /* Writes one row of a canonical dump, count may be below 16 for the last row. */
+    inline char *canonicalRow(char *out, uint64_t offset, const uint8_t *row, size_t count) {
+        out = hexOffset(out, offset);
+        *out++ = ' ';
+        for (size_t i = 0; i < 16; i++) {
+            if (i == 8)
+                *out++ = ' ';
+            *out++ = ' ';
+            if (i < count) {
+                memcpy(out, hexPairs[0][row[i]], 2);
+            } else {
+                out[0] = out[1] = ' ';
             }
-            break;
+            out += 2;
         }
+        *out++ = ' ';
+        *out++ = ' ';
+        *out++ = '|';
+        for (size_t i = 0; i < count; i++)
+            *out++ = printableAscii(row[i]) ? (char)row[i] : '.';
+        *out++ = '|';
+        *out++ = '\n';
+        return out;
     }
-    os.copyfmt(tmpState);
+
+    template <class Output>
+    void canonical(Output &out, const uint8_t *first, size_t size) {
+        static constexpr size_t block_size = 64 * 1024;
+        // An offset of up to 16 digits, the bytes in hexadecimal and ascii, and the separators.
+        static constexpr size_t row_size = 16 + 2 + 16 * 3 + 1 + 2 + 16 + 2;
+        char block[block_size];
+        char *ptr = block;
+        const uint8_t *previous = nullptr;
+        bool skipping = false;
+        for (size_t offset = 0; offset < size; offset += 16) {
+            const uint8_t *row = first + offset;
+            size_t count = std::min<size_t>(16, size - offset);
+            if (previous && count == 16 && !memcmp(row, previous, 16)) {
+                if (!skipping) {
+                    *ptr++ = '*';
+                    *ptr++ = '\n';
+                    skipping = true;
+                }
+            } else {
+                ptr = canonicalRow(ptr, offset, row, count);
+                previous = row;
+                skipping = false;
+            }
+            if ((size_t)(block + block_size - ptr) < row_size) {
+                out.write(block, ptr - block);
+                ptr = block;
+            }
+        }
+        if (size) {
+            ptr = hexOffset(ptr, size);
+            *ptr++ = '\n';
+        }
+        out.write(block, ptr - block);
+    }
+};
+
+std::ostream &ktu::operator<<(std::ostream &os, const buf_io::output &obj) {
+    if (!obj.size) return os;
+    long flags = os.iword(ktu::buf_io::manipFlagId);
+    if (!(flags & ktu::buf_io::fmtflags::fmt)) {
+        writeRaw(os, (const char*)obj.ptr, obj.size);
+        return os;
+    }
+    unsigned long grouping = os.iword(ktu::buf_io::manipGroupingId);
+    unsigned threads = (unsigned)os.iword(ktu::buf_io::manipThreadsId);
+    const uint8_t *first = (const uint8_t*)obj.ptr, *last = first + obj.size;
+    if (threads > 1 && obj.size >= parallel_threshold) {
+        renderParallel(os, flags, grouping, threads, first, last);
+        return os;
+    }
+    streamOutput out {os};
+    renderer<streamOutput> format(out, flags, grouping);
+    if (flags & ktu::buf_io::fmtflags::fmtinfo)
+        format.info();
+    format.render(first, last);
+    format.finish();
     return os;
 }
 
 
+void ktu::buf_io::dump(std::ostream &os, const void *ptr, size_t size) {
+    streamOutput out {os};
+    canonical(out, (const uint8_t*)ptr, size);
+}
+
+bool ktu::buf_io::dump(int fd, const void *ptr, size_t size) {
+    fdOutput out {fd};
+    canonical(out, (const uint8_t*)ptr, size);
+    return !out.failed;
+}
+
+void ktu::buf_io::render(const void *ptr, size_t size, long flags, unsigned long grouping,
+    void (*write)(void *context, const char *ptr, size_t size), void *context) {
+    callbackOutput out {write, context};
+    if (!size) return;
+    if (!(flags & fmtflags::fmt)) {
+        out.write((const char*)ptr, size);
+        return;
+    }
+    renderer<callbackOutput> format(out, flags, grouping);
+    if (flags & fmtflags::fmtinfo)
+        format.info();
+    format.render((const uint8_t*)ptr, (const uint8_t*)ptr + size);
+    format.finish();
+}
+
+
 // std::ifstream& operator>>(std::ifstream &ifs, std::string &str) {
 //     ifs.seekg(0, std::ios::end);
 //     str.reserve(ifs.tellg());
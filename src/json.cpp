@@ -0,0 +1,292 @@
+#include <ktu/json.hpp>
+#include <ktu/unicode.hpp>
+
+namespace {
+    using namespace ktu;
+
+    inline bool isWhitespace(uint8_t c) {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+    /* Bytes that may directly follow a number or a literal. */
+    inline bool isDelimiter(const uint8_t *ptr, const uint8_t *last) {
+        return ptr >= last || isWhitespace(*ptr) || *ptr == ',' || *ptr == ']' || *ptr == '}';
+    }
+    inline bool isDigit(uint8_t c) {
+        return c >= '0' && c <= '9';
+    }
+
+    inline simd::block load(const uint8_t *ptr, size_t remaining, uint8_t fill) {
+        return (remaining >= simd::width) ? simd::block(ptr) : simd::block::partial(ptr, remaining, fill);
+    }
+
+    const uint8_t *skipWhitespace(const uint8_t *ptr, const uint8_t *last) {
+        // Tokens are mostly separated by a single space or none at all.
+        if (ptr < last && !isWhitespace(*ptr))
+            return ptr;
+        while (ptr < last) {
+            simd::block b = load(ptr, last - ptr, 0);
+            uint64_t other = ~(b.eq(' ') | b.eq('\n') | b.eq('\r') | b.eq('\t'));
+            if (other)
+                return ptr + std::countr_zero(other);
+            ptr += simd::width;
+        }
+        return last;
+    }
+
+    /* Finds the closing quote of a string, ptr must point past the opening quote.
+        Returns nullptr if the string is unterminated or contains a control character.
+    */
+    const uint8_t *findStringEnd(const uint8_t *ptr, const uint8_t *last, bool &escaped) {
+        while (ptr < last) {
+            size_t remaining = last - ptr;
+            simd::block b = load(ptr, remaining, 'a');
+            uint64_t stop = (b.eq('"') | b.eq('\\') | b.lt(0x20)) & simd::low_bits(remaining);
+            if (!stop) {
+                ptr += simd::width;
+                continue;
+            }
+            ptr += std::countr_zero(stop);
+            if (*ptr == '"')
+                return ptr;
+            if (*ptr != '\\')
+                return nullptr;
+            escaped = true;
+            ptr += 2;
+        }
+        return nullptr;
+    }
+
+    inline int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+    inline long readCodeUnit(const char *ptr, const char *end) {
+        if (end - ptr < 4)
+            return -1;
+        long value = 0;
+        for (int i = 0; i < 4; i++) {
+            int digit = hexValue(ptr[i]);
+            if (digit < 0)
+                return -1;
+            value = (value << 4) | digit;
+        }
+        return value;
+    }
+};
+
+bool ktu::json::scanner::next() {
+    if (current.type == token_type::error)
+        return false;
+    while (true) {
+        ptr = skipWhitespace(ptr, last);
+        if (ptr >= last) {
+            if (expect != state::top)
+                return fail();
+            emit(token_type::end, last, last);
+            return false;
+        }
+        switch (expect) {
+            case state::first_value:
+                if (*ptr == ']')
+                    return close(false);
+                [[fallthrough]];
+            case state::top:
+            case state::value:
+                return value();
+            case state::first_key:
+                if (*ptr == '}')
+                    return close(true);
+                [[fallthrough]];
+            case state::key:
+                if (*ptr != '"' || !string(token_type::key))
+                    return fail();
+                expect = state::colon;
+                return true;
+            case state::colon:
+                if (*ptr != ':')
+                    return fail();
+                ++ptr;
+                expect = state::value;
+                break;
+            case state::comma:
+                if (*ptr == ',') {
+                    ++ptr;
+                    expect = (in_object()) ? state::key : state::value;
+                    break;
+                }
+                if (*ptr == '}' || *ptr == ']')
+                    return close(*ptr == '}');
+                return fail();
+        }
+    }
+}
+
+bool ktu::json::scanner::open(bool object) {
+    if (level == max_depth)
+        return fail();
+    uint64_t bit = uint64_t(1) << (level % 64);
+    stack[level / 64] = (object) ? (stack[level / 64] | bit) : (stack[level / 64] & ~bit);
+    ++level;
+    emit((object) ? token_type::object_begin : token_type::array_begin, ptr, ptr + 1);
+    ++ptr;
+    expect = (object) ? state::first_key : state::first_value;
+    return true;
+}
+
+bool ktu::json::scanner::close(bool object) {
+    if (!level || in_object() != object)
+        return fail();
+    --level;
+    emit((object) ? token_type::object_end : token_type::array_end, ptr, ptr + 1);
+    ++ptr;
+    expect = (level) ? state::comma : state::top;
+    return true;
+}
+
+bool ktu::json::scanner::value() {
+    bool result;
+    switch (*ptr) {
+        case '{':
+            return open(true);
+        case '[':
+            return open(false);
+        case '"':
+            result = string(token_type::string);
+            break;
+        case 't':
+            result = literal("true", 4, token_type::boolean);
+            break;
+        case 'f':
+            result = literal("false", 5, token_type::boolean);
+            break;
+        case 'n':
+            result = literal("null", 4, token_type::null);
+            break;
+        default:
+            result = number();
+            break;
+    }
+    if (!result)
+        return fail();
+    expect = (level) ? state::comma : state::top;
+    return true;
+}
+
+bool ktu::json::scanner::string(token_type type) {
+    bool escaped = false;
+    const uint8_t *end = findStringEnd(ptr + 1, last, escaped);
+    if (!end)
+        return false;
+    emit(type, ptr + 1, end, escaped);
+    ptr = end + 1;
+    return true;
+}
+
+bool ktu::json::scanner::number() {
+    const uint8_t *p = ptr;
+    if (p < last && *p == '-')
+        ++p;
+    if (p >= last || !isDigit(*p))
+        return false;
+    if (*p == '0') {
+        ++p;
+    } else {
+        while (p < last && isDigit(*p))
+            ++p;
+    }
+    if (p < last && *p == '.') {
+        ++p;
+        if (p >= last || !isDigit(*p))
+            return false;
+        while (p < last && isDigit(*p))
+            ++p;
+    }
+    if (p < last && (*p == 'e' || *p == 'E')) {
+        ++p;
+        if (p < last && (*p == '+' || *p == '-'))
+            ++p;
+        if (p >= last || !isDigit(*p))
+            return false;
+        while (p < last && isDigit(*p))
+            ++p;
+    }
+    if (!isDelimiter(p, last))
+        return false;
+    emit(token_type::number, ptr, p);
+    ptr = p;
+    return true;
+}
+
+bool ktu::json::scanner::literal(const char *text, size_t size, token_type type) {
+    if ((size_t)(last - ptr) < size || memcmp(ptr, text, size) || !isDelimiter(ptr + size, last))
+        return false;
+    emit(type, ptr, ptr + size);
+    ptr += size;
+    return true;
+}
+
+bool ktu::json::scanner::fail() {
+    emit(token_type::error, ptr, ptr);
+    return false;
+}
+
+
+
+char *ktu::json::unescape(const view &data, char *out) {
+    const char *ptr = data.begin<char>(), *end = data.end<char>();
+    while (ptr < end) {
+        const char *next = (const char*)memchr(ptr, '\\', end - ptr);
+        if (!next)
+            next = end;
+        memmove(out, ptr, next - ptr);
+        out += next - ptr;
+        ptr = next;
+        if (ptr == end)
+            break;
+        if (++ptr == end)
+            return nullptr;
+        switch (*ptr++) {
+            case '"':  *out++ = '"';  break;
+            case '\\': *out++ = '\\'; break;
+            case '/':  *out++ = '/';  break;
+            case 'b':  *out++ = '\b'; break;
+            case 'f':  *out++ = '\f'; break;
+            case 'n':  *out++ = '\n'; break;
+            case 'r':  *out++ = '\r'; break;
+            case 't':  *out++ = '\t'; break;
+            case 'u': {
+                long codepoint = readCodeUnit(ptr, end);
+                if (codepoint < 0)
+                    return nullptr;
+                ptr += 4;
+                if (codepoint >= 0xD800 && codepoint < 0xDC00) {
+                    if (end - ptr < 2 || ptr[0] != '\\' || ptr[1] != 'u')
+                        return nullptr;
+                    long low = readCodeUnit(ptr + 2, end);
+                    if (low < 0xDC00 || low >= 0xE000)
+                        return nullptr;
+                    ptr += 6;
+                    codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                } else if (codepoint >= 0xDC00 && codepoint < 0xE000) {
+                    return nullptr;
+                }
+                out += u8::write((uint32_t)codepoint, out);
+                break;
+            }
+            default:
+                return nullptr;
+        }
+    }
+    return out;
+}
+
+std::string ktu::json::unescape(const view &data) {
+    std::string result(data.size(), '\0');
+    char *end = unescape(data, result.data());
+    if (!end)
+        return std::string();
+    result.resize(end - result.data());
+    return result;
+}
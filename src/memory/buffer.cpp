@@ -1,5 +1,8 @@
 #include <ktu/memory/buffer.hpp>
 #include <ktu/algorithm.hpp>
+#include <ktu/simd.hpp>
+#include <unistd.h>
+#include <cerrno>
 
 
 ktu::buffer::buffer() {}
@@ -125,441 +128,611 @@ std::weak_ordering ktu::buffer::operator<=> (const buffer &other) const {
 
 
 
-constexpr unsigned long ktu::readBin(const char *&ptr, long size) {
-    unsigned long ret = 0; 
-    while (size--) {
-        char cur = *ptr;
-        if (cur != '0' && cur != '1') return ret;
-        ptr++;
-        ret = (ret << 1) | (cur & 1);
+namespace {
+    /* Step of ktu::hash, so identifiers can be hashed while they arrive in pieces. */
+    constexpr size_t FNVoffsetBasis = (sizeof(size_t) == 8) ? 0xcbf29ce484222325 : 0x811c9dc5;
+    constexpr size_t FNVprime = (sizeof(size_t) == 8) ? 0x00000100000001B3 : 0x01000193;
+    constexpr size_t hashStep(size_t hash, uint8_t c) {
+        return (hash ^ (size_t)(char)c) * FNVprime;
     }
-    return ret;
-}
-constexpr bool ktu::isBin(const char c) {
-    return c == '0' || c == '1';
-}
-
-constexpr unsigned long ktu::readOct(const char *&ptr, long size) {
-    unsigned long ret = 0; 
-    while (size--) {
-        char cur = *ptr;
-        if (cur < '0' || cur > '7') return ret;
-        ptr++;
-        ret = (ret << 3) | (cur & 0x7);
-    }
-    return ret;
-}
-constexpr bool ktu::isOct(const char c) {
-    return '0' <= c && c <= '7';
-}
-
-
-constexpr unsigned long ktu::readDec(const char *&ptr, long size) {
-    unsigned long ret = 0; 
-    while (size--) {
-        char cur = *ptr;
-        if (cur < '0' || cur > '9') return ret;
-        ptr++;
-        ret = (ret * 10) + (cur - '0');
-    }
-    return ret;
-}
-constexpr bool ktu::isDec(const char c) {
-    return '0' <= c && c <= '9';
-}
-
-static constexpr const char Hextable[] = { 
-    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
-    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
-    -1,-1, 0,1,2,3,4,5,6,7,8,9,-1,-1,-1,-1,-1,-1,-1,10,11,12,13,14,15,-1,
-    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
-    -1,-1,10,11,12,13,14,15,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
-    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
-    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
-    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
-    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
-    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
-    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
-};
-
-constexpr unsigned long ktu::readHex(const char *&ptr, long size) {
-    unsigned long ret = 0; 
-    while (size--) {
-        char cur = Hextable[(int)*ptr];
-        if (cur == -1) return ret;
-        ptr++;
-        ret = (ret << 4) | cur;
-    }
-    return ret;
-}
-constexpr bool ktu::isHex(const char c) {
-    return Hextable[c] != -1;
-}
-
+    static_assert(hashStep(hashStep(hashStep(FNVoffsetBasis, 'h'), 'e'), 'x') == ktu::hash("hex"));
 
+    struct counter {
+        static constexpr bool counting = true;
+        size_t size = 0;
+        inline void put(uint8_t) {++size;}
+        inline void append(const void*, size_t count) {size += count;}
+    };
+    struct writer {
+        static constexpr bool counting = false;
+        uint8_t *out;
+        inline void put(uint8_t value) {*out++ = value;}
+        inline void append(const void *ptr, size_t count) {
+            memcpy(out, ptr, count);
+            out += count;
+        }
+    };
 
-const char *ktu::readVariable(const char *ptr) {
-    char value = *ptr;
-    if (
-            (value < 'A' || 'Z' < value) &&
-            (value < 'a' || 'z' < value) &&
-            value != '_'
-    ) return ptr;
-    while (true) {
-        value = *ptr;
-        next:
-        if (
-            (value < 'A' || 'Z' < value) &&
-            (value < 'a' || 'z' < value) &&
-            (value < '0' || '9' < value) &&
-            value != '_'
-        ) {
+    /* Bytes that every text encoding copies through unchanged: printable ascii apart from '[' and '\\'. */
+    const uint8_t *plainRun(const uint8_t *ptr, const uint8_t *eos) {
+        if (ptr < eos && (*ptr < 0x20 || *ptr > 0x7E || *ptr == '[' || *ptr == '\\'))
             return ptr;
+        while (ptr < eos) {
+            size_t remaining = eos - ptr;
+            ktu::simd::block b = (remaining >= ktu::simd::width) ? ktu::simd::block(ptr) : ktu::simd::block::partial(ptr, remaining);
+            uint64_t stop = ~b.in(0x20, 0x7E) | b.eq('[') | b.eq('\\');
+            if (stop)
+                return ptr + std::countr_zero(stop);
+            ptr += ktu::simd::width;
         }
-        ptr++;
+        return eos;
     }
-}
-constexpr bool ktu::isVariableStart(const char c) {
-    return ('A' <= c && c <= 'Z') ||
-        ('a' <= c && c <= 'z') ||
-        c == '_';
-}
 
-
-
-void ktu::buffer::input(const char *ptr, size_t ssize, long flags) {
-
-    auto eos = ptr + ssize;
-    char value;
-    
-    
-    unsigned long (*readNumeric)(const char *&ptr, long size);
-    bool (*checkNumeric)(char c);
-    long size;
-
-    size_t (*write)(uint32_t,void*);
-    int factor;
-
-    char buf[4];
-    uint32_t codepoint;
-
-    enum {
-        unchanged,
-        numeric,
-        latin_1,
-        ascii,
-        unicode,
-    };
-
-    auto updateFormatting = [&ptr, &eos, &value, &readNumeric, &checkNumeric, &size, &write, &factor]() {
-        while (ptr != eos) {
-            while (ptr != eos && !isVariableStart(value = (*ptr))) {
-                ptr++;
-                if (value == ']') {
-                    return unchanged;
-                }
-                    
+    /* Decodes count pairs of hex digits, the input must already be known to be hex digits. */
+    uint8_t *decodeHex(uint8_t *out, const uint8_t *ptr, size_t count) {
+        // The value of a hex digit is its low nibble, plus 9 for letters which are the only digits with bit 6 set.
+        #if defined(__SSE2__)
+            const __m128i low = _mm_set1_epi8(0x0F), one = _mm_set1_epi8(0x01), mask = _mm_set1_epi16(0x00FF);
+            for (; count >= 8; count -= 8, ptr += 16, out += 8) {
+                __m128i x = _mm_loadu_si128((const __m128i*)ptr);
+                __m128i letter = _mm_and_si128(_mm_srli_epi16(x, 6), one);
+                __m128i nibble = _mm_add_epi8(_mm_and_si128(x, low), _mm_add_epi8(_mm_slli_epi16(letter, 3), letter));
+                __m128i pair = _mm_and_si128(_mm_or_si128(_mm_slli_epi16(nibble, 4), _mm_srli_epi16(nibble, 8)), mask);
+                _mm_storel_epi64((__m128i*)out, _mm_packus_epi16(pair, pair));
             }
-            if (ptr == eos)
-                return unchanged;
-            
-            const char *tmp = ptr;
-            ptr = ktu::readVariable(ptr);
-            switch (ktu::hash(tmp, ptr-tmp)) {
-                case ktu::hash("bin"):
-                    readNumeric = readBin;
-                    checkNumeric = isBin;
-                    size = 8;
-                    break;
-                case ktu::hash("oct"):
-                    readNumeric = readOct;
-                    checkNumeric = isOct;
-                    size = 3;
-                    break;
-                case ktu::hash("dec"):
-                    readNumeric = readDec;
-                    checkNumeric = isDec;
-                    size = 3;
-                    break;
-                case ktu::hash("hex"):
-                    readNumeric = readHex;
-                    checkNumeric = isHex;
-                    size = 2;
-                    break;
-                case ktu::hash("numeric"):
-                    return numeric;
-                case ktu::hash("ascii"):
-                    return ascii;
-                case ktu::hash("latin_1"):
-                    return latin_1;
-                case ktu::hash("utf_8"):
-                    write = ktu::u8::ptr::write;
-                    factor = 0;
-                    return unicode;
-                case ktu::hash("utf_16le"):
-                    write = ktu::u16::ptr::write_le;
-                    factor = 1;
-                    return unicode;
-                case ktu::hash("utf_16be"):
-                    write = ktu::u16::ptr::write_be;
-                    factor = 1;
-                    return unicode;
-                case ktu::hash("utf_32le"):
-                    write = ktu::u32::ptr::write_le;
-                    factor = 2;
-                    return unicode;
-                case ktu::hash("utf_32be"):
-                    write = ktu::u32::ptr::write_be;
-                    factor = 2;
-                    return unicode;
+        #endif
+        if constexpr (std::endian::native == std::endian::little) {
+            for (; count >= 4; count -= 4, ptr += 8, out += 4) {
+                uint64_t x;
+                memcpy(&x, ptr, 8);
+                uint64_t letter = (x >> 6) & 0x0101010101010101;
+                uint64_t nibble = (x & 0x0F0F0F0F0F0F0F0F) + (letter << 3) + letter;
+                uint64_t pair = ((nibble & 0x00FF00FF00FF00FF) << 4) | ((nibble >> 8) & 0x00FF00FF00FF00FF);
+                pair = (pair | (pair >> 8)) & 0x0000FFFF0000FFFF;
+                uint32_t bytes = (uint32_t)(pair | (pair >> 16));
+                memcpy(out, &bytes, 4);
             }
+        }
+        for (; count; count--, ptr += 2)
+            *out++ = (ktu::charclass::digit[ptr[0]] << 4) | ktu::charclass::digit[ptr[1]];
+        return out;
+    }
 
-
+    /* Decodes count groups of 8 binary digits. */
+    uint8_t *decodeBin(uint8_t *out, const uint8_t *ptr, size_t count) {
+        for (; count; count--, ptr += 8) {
+            uint64_t x;
+            memcpy(&x, ptr, 8);
+            x = ktu::little_endian(x) - 0x3030303030303030;
+            // Every digit lands on its own bit of the top byte, the first digit on the highest.
+            *out++ = (uint8_t)((x * 0x8040201008040201) >> 56);
         }
-        return unchanged;
-    };
-    bool inExpression = false;
-    
-    auto numericSection = [this, &updateFormatting, &ptr, &eos, &value, &readNumeric, &checkNumeric, &size, &inExpression]
-    <bool enableInternalNumeric = true>
-    () {
-        if (inExpression) goto expression;
-        while (ptr != eos) {
-            value = *ptr;
-            if constexpr (enableInternalNumeric) {
-                if (checkNumeric(value)) {
-                    push_back<value_type>(readNumeric(ptr, size));
-                    continue;
-                }
-            }
-            
-            ptr++;
-            if (value == ']')
-                break;
-            if (value == '[') {
-                expression:
-                inExpression = true;
-                switch (updateFormatting()) {
-                    case unchanged:
-                        break;
-                    case numeric:
-                        return numeric;
-                    case ascii:
-                        return ascii;
-                    case latin_1:
-                        return latin_1;
-                    case unicode:
-                        return unicode;
-                }
-                inExpression = false;
+        return out;
+    }
+
+    /* Decodes count groups of 3 decimal digits, keeping the low byte of each value. */
+    uint8_t *decodeDec(uint8_t *out, const uint8_t *ptr, size_t count) {
+        #if defined(__SSSE3__)
+            // Four groups per step, loads 16 bytes so at least 6 groups have to remain.
+            const __m128i gather = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+            const __m128i weights = _mm_setr_epi8(100, 10, 1, 0, 100, 10, 1, 0, 100, 10, 1, 0, 100, 10, 1, 0);
+            const __m128i pack = _mm_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+            for (; count >= 6; count -= 4, ptr += 12, out += 4) {
+                __m128i x = _mm_sub_epi8(_mm_loadu_si128((const __m128i*)ptr), _mm_set1_epi8('0'));
+                __m128i sums = _mm_madd_epi16(_mm_maddubs_epi16(_mm_shuffle_epi8(x, gather), weights), _mm_set1_epi16(1));
+                uint32_t bytes = (uint32_t)_mm_cvtsi128_si32(_mm_shuffle_epi8(sums, pack));
+                memcpy(out, &bytes, 4);
             }
-        }
-        return unchanged;
-    };
+        #endif
+        for (; count; count--, ptr += 3)
+            *out++ = (uint8_t)((ptr[0] - '0') * 100 + (ptr[1] - '0') * 10 + (ptr[2] - '0'));
+        return out;
+    }
+
+    uint8_t *decodeOct(uint8_t *out, const uint8_t *ptr, size_t count) {
+        for (; count; count--, ptr += 3)
+            *out++ = (uint8_t)(((ptr[0] - '0') << 6) | ((ptr[1] - '0') << 3) | (ptr[2] - '0'));
+        return out;
+    }
+};
 
-    switch (flags & ktu::buf_io::fmtflags::basefield) {
-        case ktu::buf_io::fmtflags::bin:
-            readNumeric = readBin;
-            checkNumeric = isBin;
-            size = 8;
+ktu::buffer::decoder::decoder(long flags) {
+    switch (flags & buf_io::fmtflags::basefield) {
+        case buf_io::fmtflags::bin:
+            setBase(2);
             break;
-        case ktu::buf_io::fmtflags::oct:
-            readNumeric = readOct;
-            checkNumeric = isOct;
-            size = 3;
+        case buf_io::fmtflags::oct:
+            setBase(8);
             break;
-        case ktu::buf_io::fmtflags::dec:
-            readNumeric = readDec;
-            checkNumeric = isDec;
-            size = 3;
+        case buf_io::fmtflags::dec:
+            setBase(10);
             break;
-        case ktu::buf_io::fmtflags::hex:
-            readNumeric = readHex;
-            checkNumeric = isHex;
-            size = 2;
+        default:
+            setBase(16);
             break;
     }
+    setEncoding((flags & buf_io::fmtflags::encodingfield) >> 2);
+}
 
-    auto writeChar = [this, &value]() {
-        push_back<value_type>(value);
-    };
-
-    
-    switch (flags & ktu::buf_io::fmtflags::encodingfield) {
-        case ktu::buf_io::fmtflags::numeric:
-            while (ptr != eos) {
-                value = *ptr;
-                if (checkNumeric(value)) {
-                    push_back<value_type>(readNumeric(ptr, size));
-                } else {
-                    ptr++;
-                    if (value == '[') {
-                        numericNumericSection:
-                        switch (numericSection.operator()<false>()) {
-                            case numeric:
-                                goto numericNumericSection;
-                            case ascii:
-                                goto asciiNumericSection;
-                            case latin_1:
-                                goto latin_1NumericSection;
-                            case unicode:
-                                goto unicodeNumericSection;
-                            default:
-                                break;
-                        }
-                    }
-                }
-            }
+void ktu::buffer::decoder::setBase(uint8_t base) {
+    this->base = base;
+    switch (base) {
+        case 2:
+            digits = 8;
             break;
-        case ktu::buf_io::fmtflags::ascii:
-            while (ptr != eos) {
-                value = *ptr++;
-                if (value == '[') {
-                    asciiNumericSection:
-                    switch (numericSection()) {
-                        case numeric:
-                            goto numericNumericSection;
-                        case ascii:
-                            goto asciiNumericSection;
-                        case latin_1:
-                            goto latin_1NumericSection;
-                        case unicode:
-                            goto unicodeNumericSection;
-                        default:
-                            break;
-                    }
-                } else if (value == '\\') {
-                    value = ktu::u8::read(&ptr);
-                    if (value == '[' || value == '\\')
-                        writeChar();
-                } else if (value == '\n') {
-                    push_back<value_type>(' ');
-                } else if (0x1F < (unsigned char)value && (unsigned char)value < 0x7F) {
-                    writeChar();
-                }
-            }
+        case 16:
+            digits = 2;
             break;
-        case ktu::buf_io::fmtflags::latin_1:
-            while (ptr != eos) {
-                value = ktu::u8::read(&ptr);
-                if (value == '[') {
-                    latin_1NumericSection:
-                    switch (numericSection()) {
-                        case numeric:
-                            goto numericNumericSection;
-                        case ascii:
-                            goto asciiNumericSection;
-                        case latin_1:
-                            goto latin_1NumericSection;
-                        case unicode:
-                            goto unicodeNumericSection;
-                        default:
-                            break;
-                    }
-                } else if (value == '\\') {
-                    value = ktu::u8::read(&ptr);
-                    if (value == '[' || value == '\\')
-                        writeChar();
-                } else if (value == '\n') {
-                    push_back<value_type>(' ');
-                } else if ((0x1F < (unsigned char)value && (unsigned char)value < 0x7F) || ((unsigned char)value > 0xA0)) {
-                    writeChar();
-                }
-            }
+        default:
+            digits = 3;
             break;
-        case ktu::buf_io::fmtflags::utf_8:
+    }
+}
+
+void ktu::buffer::decoder::setEncoding(uint8_t encoding) {
+    this->encoding = encoding;
+    // Only the unicode encodings widen plain characters.
+    write = nullptr;
+    factor = 0;
+    switch (encoding << 2) {
+        case buf_io::fmtflags::utf_8:
             write = ktu::u8::ptr::write;
-            factor = 0;
             break;
-        case ktu::buf_io::fmtflags::utf_16le:
+        case buf_io::fmtflags::utf_16le:
             write = ktu::u16::ptr::write_le;
             factor = 1;
             break;
-        case ktu::buf_io::fmtflags::utf_16be:
+        case buf_io::fmtflags::utf_16be:
             write = ktu::u16::ptr::write_be;
             factor = 1;
             break;
-        case ktu::buf_io::fmtflags::utf_32le:
+        case buf_io::fmtflags::utf_32le:
             write = ktu::u32::ptr::write_le;
             factor = 2;
             break;
-        case ktu::buf_io::fmtflags::utf_32be:
+        case buf_io::fmtflags::utf_32be:
             write = ktu::u32::ptr::write_be;
             factor = 2;
             break;
     }
+}
 
-    
+void ktu::buffer::decoder::apply(size_t hash) {
+    switch (hash) {
+        case ktu::hash("bin"):
+            setBase(2);
+            break;
+        case ktu::hash("oct"):
+            setBase(8);
+            break;
+        case ktu::hash("dec"):
+            setBase(10);
+            break;
+        case ktu::hash("hex"):
+            setBase(16);
+            break;
+        case ktu::hash("numeric"):
+            setEncoding(buf_io::fmtflags::numeric >> 2);
+            break;
+        case ktu::hash("ascii"):
+            setEncoding(buf_io::fmtflags::ascii >> 2);
+            break;
+        case ktu::hash("latin_1"):
+            setEncoding(buf_io::fmtflags::latin_1 >> 2);
+            break;
+        case ktu::hash("utf_8"):
+            setEncoding(buf_io::fmtflags::utf_8 >> 2);
+            break;
+        case ktu::hash("utf_16le"):
+            setEncoding(buf_io::fmtflags::utf_16le >> 2);
+            break;
+        case ktu::hash("utf_16be"):
+            setEncoding(buf_io::fmtflags::utf_16be >> 2);
+            break;
+        case ktu::hash("utf_32le"):
+            setEncoding(buf_io::fmtflags::utf_32le >> 2);
+            break;
+        case ktu::hash("utf_32be"):
+            setEncoding(buf_io::fmtflags::utf_32be >> 2);
+            break;
+    }
+}
 
-    
+/* Collects one utf-8 sequence, decoding it the same way as u8::read. Returns false while the sequence is incomplete. */
+bool ktu::buffer::decoder::utf8(uint8_t c, uint32_t &codepoint) {
+    if (!sequenceSize) {
+        if (c < 0x80) {
+            codepoint = c;
+            return true;
+        }
+        if (c < 0xC0) {
+            codepoint = 0xFFFD;
+            return true;
+        }
+        sequence[0] = c;
+        sequenceSize = 1;
+        sequenceLength = (c < 0xE0) ? 2 : (c < 0xF0) ? 3 : 4;
+        return false;
+    }
+    if (!c) {
+        sequenceSize = 0;
+        codepoint = 0xFFFD;
+        return true;
+    }
+    sequence[sequenceSize++] = c;
+    if (sequenceSize != sequenceLength)
+        return false;
+    sequenceSize = 0;
+    switch (sequenceLength) {
+        case 2:
+            codepoint = ((sequence[0] & 0x1F) << 6) | (sequence[1] & 0x3F);
+            break;
+        case 3:
+            codepoint = ((sequence[0] & 0xF) << 12) | ((sequence[1] & 0x3F) << 6) | (sequence[2] & 0x3F);
+            break;
+        default:
+            codepoint = (sequence[0] < 0xF8) ?
+                ((sequence[0] & 0x7) << 18) | ((sequence[1] & 0x3F) << 12) | ((sequence[2] & 0x3F) << 6) | (sequence[3] & 0x3F) :
+                0xFFFD;
+            break;
+    }
+    return true;
+}
+
+template <class Sink>
+void ktu::buffer::decoder::codepoint(Sink &sink, uint32_t codepoint) {
+    uint8_t buf[4];
+    sink.append(buf, write(codepoint, &buf[0]) << factor);
+}
+
+/* A character outside of brackets in one of the text encodings. */
+template <class Sink>
+void ktu::buffer::decoder::unit(Sink &sink, uint32_t value) {
+    if (encoding < (buf_io::fmtflags::utf_8 >> 2)) {
+        // ascii and latin_1 only look at the low byte of a codepoint.
+        uint8_t c = (uint8_t)value;
+        if (escape) {
+            escape = false;
+            if (c == '[' || c == '\\')
+                sink.put(c);
+        } else if (c == '[') {
+            state = section;
+        } else if (c == '\\') {
+            escape = true;
+        } else if (c == '\n') {
+            sink.put(' ');
+        } else if ((0x1F < c && c < 0x7F) || (encoding == (buf_io::fmtflags::latin_1 >> 2) && c > 0xA0)) {
+            sink.put(c);
+        }
+        return;
+    }
+    if (escape) {
+        escape = false;
+        if (value == '[' || value == '\\')
+            codepoint(sink, value);
+    } else if (value == '[') {
+        state = section;
+    } else if (value == '\\') {
+        escape = true;
+    } else if (value == '\n') {
+        codepoint(sink, ' ');
+    } else if (value > 0x1F) {
+        codepoint(sink, value);
+    }
+}
+
+template <class Sink>
+const uint8_t *ktu::buffer::decoder::text(Sink &sink, const uint8_t *ptr, const uint8_t *eos) {
+    while (ptr < eos && state == top) {
+        if (!escape && !sequenceSize) {
+            const uint8_t *end = plainRun(ptr, eos);
+            size_t count = end - ptr;
+            if (count) {
+                if (Sink::counting || !factor) {
+                    sink.append(ptr, count << factor);
+                } else if constexpr (!Sink::counting) {
+                    // The encodings are stored in order le, be, so the lowest bit selects big endian.
+                    bool bigEndian = encoding & 1;
+                    size_t width = size_t(1) << factor;
+                    uint8_t *out = sink.out;
+                    memset(out, 0, count << factor);
+                    for (size_t i = 0; i < count; i++)
+                        out[i * width + (bigEndian ? width - 1 : 0)] = ptr[i];
+                    sink.out += count << factor;
+                }
+                ptr = end;
+                continue;
+            }
+        }
+        uint8_t c = *ptr++;
+        uint32_t value;
+        if (encoding == (buf_io::fmtflags::ascii >> 2) && !escape) {
+            // Unescaped ascii is read byte by byte, only an escaped character is decoded as utf-8.
+            value = c;
+        } else if (!utf8(c, value)) {
+            continue;
+        }
+        unit(sink, value);
+    }
+    return ptr;
+}
+
+template <class Sink>
+const uint8_t *ktu::buffer::decoder::numbers(Sink &sink, const uint8_t *ptr, const uint8_t *eos) {
+    // Complete a number started by the previous input.
+    while (numberSize && ptr < eos) {
+        uint8_t value = ktu::charclass::digit[*ptr];
+        if (value >= base) {
+            sink.put((uint8_t)number);
+            number = numberSize = 0;
+            return ptr;
+        }
+        number = number * base + value;
+        ++ptr;
+        if (++numberSize == digits) {
+            sink.put((uint8_t)number);
+            number = numberSize = 0;
+        }
+    }
+    if (ptr == eos)
+        return ptr;
+
+    const char *end;
+    switch (base) {
+        case 2:
+            end = ktu::scanBin((const char*)ptr, (const char*)eos);
+            break;
+        case 8:
+            end = ktu::scanOct((const char*)ptr, (const char*)eos);
+            break;
+        case 10:
+            end = ktu::scanDec((const char*)ptr, (const char*)eos);
+            break;
+        default:
+            end = ktu::scanHex((const char*)ptr, (const char*)eos);
+            break;
+    }
+    size_t groups = ((const uint8_t*)end - ptr) / digits;
+    if constexpr (Sink::counting) {
+        sink.size += groups;
+    } else {
+        switch (base) {
+            case 2:
+                sink.out = decodeBin(sink.out, ptr, groups);
+                break;
+            case 8:
+                sink.out = decodeOct(sink.out, ptr, groups);
+                break;
+            case 10:
+                sink.out = decodeDec(sink.out, ptr, groups);
+                break;
+            default:
+                sink.out = decodeHex(sink.out, ptr, groups);
+                break;
+        }
+    }
+    ptr += groups * digits;
+    for (; ptr < (const uint8_t*)end; ptr++, numberSize++)
+        number = number * base + ktu::charclass::digit[*ptr];
+    // A shorter number ends at the next character, unless the input ends first.
+    if (numberSize && ptr < eos) {
+        sink.put((uint8_t)number);
+        number = numberSize = 0;
+    }
+    return ptr;
+}
+
+/* Inside brackets numbers are read in every encoding but numeric, everything else up to the closing bracket is ignored. */
+template <class Sink>
+const uint8_t *ktu::buffer::decoder::bracket(Sink &sink, const uint8_t *ptr, const uint8_t *eos) {
+    bool readNumbers = encoding != (buf_io::fmtflags::numeric >> 2);
     while (ptr < eos) {
-        codepoint = ktu::u8::read(&ptr);
-        
-        if (codepoint == '[') {
-            unicodeNumericSection:
-            switch (numericSection()) {
-                case numeric:
-                    goto numericNumericSection;
-                case ascii:
-                    goto asciiNumericSection;
-                case latin_1:
-                    goto latin_1NumericSection;
-                case unicode:
-                    goto unicodeNumericSection;
-                default:
+        if (readNumbers && (numberSize || ktu::charclass::digit[*ptr] < base)) {
+            ptr = numbers(sink, ptr, eos);
+            continue;
+        }
+        uint8_t c = *ptr++;
+        if (c == ']') {
+            state = top;
+            break;
+        }
+        if (c == '[') {
+            state = expression;
+            break;
+        }
+    }
+    return ptr;
+}
+
+/* Identifiers between nested brackets select the base and encoding. */
+const uint8_t *ktu::buffer::decoder::directive(const uint8_t *ptr, const uint8_t *eos) {
+    while (ptr < eos) {
+        uint8_t c = *ptr;
+        if (identifier) {
+            if (ktu::isVariable(c)) {
+                hash = hashStep(hash, c);
+                ++ptr;
+                continue;
+            }
+            identifier = false;
+            apply(hash);
+        }
+        ++ptr;
+        if (ktu::isVariableStart(c)) {
+            identifier = true;
+            hash = hashStep(FNVoffsetBasis, c);
+        } else if (c == ']') {
+            state = section;
+            break;
+        }
+    }
+    return ptr;
+}
+
+template <class Sink>
+void ktu::buffer::decoder::run(Sink &sink, const uint8_t *ptr, const uint8_t *eos) {
+    while (ptr < eos) {
+        switch (state) {
+            case expression:
+                ptr = directive(ptr, eos);
+                break;
+            case section:
+                ptr = bracket(sink, ptr, eos);
+                break;
+            default:
+                if (encoding != (buf_io::fmtflags::numeric >> 2)) {
+                    ptr = text(sink, ptr, eos);
                     break;
+                }
+                if (numberSize || ktu::charclass::digit[*ptr] < base) {
+                    ptr = numbers(sink, ptr, eos);
+                } else if (*ptr++ == '[') {
+                    state = section;
+                }
+                break;
+        }
+    }
+}
+
+/* Anything left open behaves as if the input was followed by a null character. */
+template <class Sink>
+void ktu::buffer::decoder::flush(Sink &sink) {
+    if (numberSize) {
+        sink.put((uint8_t)number);
+        number = numberSize = 0;
+    }
+    if (identifier) {
+        identifier = false;
+        apply(hash);
+    }
+    if (sequenceSize) {
+        sequenceSize = 0;
+        unit(sink, 0xFFFD);
+    }
+    escape = false;
+}
+
+void ktu::buffer::decoder::feed(buffer &buf, const char *ptr, size_t size) {
+    // No character decodes to more than 4 bytes.
+    size_t required = buf.priv.size + size * 4;
+    if (required > buf.priv.capacity)
+        buf.reserve(std::max(required, buf.priv.capacity * 2));
+    writer sink {buf.priv.data + buf.priv.size};
+    run(sink, (const uint8_t*)ptr, (const uint8_t*)ptr + size);
+    buf.priv.size = sink.out - buf.priv.data;
+}
+
+void ktu::buffer::decoder::finish(buffer &buf) {
+    buf.reserve(buf.priv.size + 4);
+    writer sink {buf.priv.data + buf.priv.size};
+    flush(sink);
+    buf.priv.size = sink.out - buf.priv.data;
+}
+
+size_t ktu::buffer::decoder::measure(const char *ptr, size_t size, bool final) const {
+    decoder copy = *this;
+    counter sink;
+    copy.run(sink, (const uint8_t*)ptr, (const uint8_t*)ptr + size);
+    if (final)
+        copy.flush(sink);
+    return sink.size;
+}
+
+void ktu::buffer::input(const char *ptr, size_t size, long flags) {
+    decoder parser(flags);
+    reserve(priv.size + parser.measure(ptr, size, true));
+    writer sink {priv.data + priv.size};
+    parser.run(sink, (const uint8_t*)ptr, (const uint8_t*)ptr + size);
+    parser.flush(sink);
+    priv.size = sink.out - priv.data;
+}
+
+namespace {
+    /* Reads up to size bytes, stopping after a newline when line is set.
+        Sets end once the input or the line is exhausted.
+    */
+    size_t readBlock(std::streambuf *sb, char *dst, size_t size, bool line, bool &end, bool &eof) {
+        if (!line) {
+            size_t count = (size_t)sb->sgetn(dst, (std::streamsize)size);
+            eof = end = count < size;
+            return count;
+        }
+        size_t count = 0;
+        while (count < size) {
+            int c = sb->sbumpc();
+            if (c == std::char_traits<char>::eof()) {
+                eof = end = true;
+                break;
+            }
+            if (c == '\n') {
+                end = true;
+                break;
             }
-        } else if (codepoint == '\\') {
-            codepoint = ktu::u8::read(&ptr);
-            if (codepoint == '[' || codepoint == '\\')
-                goto write_codepoint;
-        } else if (codepoint == '\n') {
-            codepoint = ' ';
-            goto write_codepoint;
-        } else if (codepoint > 0x1F) {
-            write_codepoint:
-            size_t size = write(codepoint, &buf[0]) << factor;
-            insert(end(), &buf[0], size);
+            dst[count++] = (char)c;
         }
-        
+        return count;
+    }
 
-        
-        //std::cout << size << '\n';
+    bool readFd(int fd, char *dst, size_t size, size_t &count) {
+        ssize_t result;
+        do {
+            result = ::read(fd, dst, size);
+        } while (result < 0 && errno == EINTR);
+        count = (result > 0) ? (size_t)result : 0;
+        return result >= 0;
+    }
+};
 
-        //std::cout << ktu::buf_io::fmt << ktu::buf_io::output(&buf[0], size) << '\n';
+bool ktu::buffer::pushf(int fd) {
+    while (true) {
+        reserve(std::max(priv.size + block_size, priv.capacity));
+        size_t count;
+        bool success = readFd(fd, (char*)priv.data + priv.size, priv.capacity - priv.size, count);
+        priv.size += count;
+        if (!success || !count)
+            return success;
     }
 }
 
+bool ktu::buffer::input(int fd, long flags) {
+    decoder parser(flags);
+    char block[block_size];
+    size_t count;
+    bool success;
+    while ((success = readFd(fd, block, block_size, count)) && count)
+        parser.feed(*this, block, count);
+    parser.finish(*this);
+    return success;
+}
+
 std::istream &ktu::operator>>(std::istream &is, buffer &buf) {
+    std::istream::sentry sentry(is, true);
+    if (!sentry)
+        return is;
     long flags = is.iword(buf_io::manipFlagId);
-    if (flags & buf_io::fmtflags::eosfield) {
-        if (is.iword(buf_io::manipFlagId) & buf_io::fmtflags::fmtfield) {
-            std::string str;
-            is.seekg(0, std::ios::end);
-            str.reserve(is.tellg());
-            is.seekg(0, std::ios::beg);
-            str.assign((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
-            buf.input(str);
-            return is;
-        }
-        size_t size = buf.size();
-        is.seekg(0, std::ios::end);
-        buf.resize(size + is.tellg());
-        is.seekg(0, std::ios::beg);
-        is.read(buf.data<char>() + size, buf.size());
-        return is;   
-    }
+    bool line = !(flags & buf_io::fmtflags::eosfield), end = false, eof = false;
+    std::streambuf *sb = is.rdbuf();
+    size_t total = 0;
     if (flags & buf_io::fmtflags::fmtfield) {
-        std::string str;
-        std::getline(is, str);
-        buf.input(str);
-        return is;
-    }
-    char c;
-    while ((c = is.get()) != '\n') {
-        buf.push_back(c);
+        buffer::decoder parser(flags);
+        char block[buffer::block_size];
+        while (!end) {
+            size_t count = readBlock(sb, block, buffer::block_size, line, end, eof);
+            parser.feed(buf, block, count);
+            total += count;
+        }
+        parser.finish(buf);
+    } else {
+        while (!end) {
+            // Raw input is read straight into the unused capacity.
+            buf.reserve(std::max(buf.priv.size + buffer::block_size, buf.priv.capacity));
+            size_t count = readBlock(sb, (char*)buf.priv.data + buf.priv.size, buf.priv.capacity - buf.priv.size, line, end, eof);
+            buf.priv.size += count;
+            total += count;
+        }
     }
-    
+    if (eof)
+        is.setstate((line && !total) ? std::ios::eofbit | std::ios::failbit : std::ios::eofbit);
     return is;
 }
 
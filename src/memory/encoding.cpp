@@ -0,0 +1,266 @@
+#include <ktu/memory/encoding.hpp>
+#include <ktu/charclass.hpp>
+#if defined(__AVX2__) || defined(__SSSE3__)
+    #include <immintrin.h>
+#endif
+
+namespace {
+    constexpr char hexLower[] = "0123456789abcdef";
+    constexpr char hexUpper[] = "0123456789ABCDEF";
+    constexpr char base64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    /* Value of every byte as a base64 digit, 0xFF for bytes outside the alphabet. */
+    constexpr std::array<uint8_t, 256> base64Digit = [] {
+        std::array<uint8_t, 256> result = {};
+        for (auto &value : result)
+            value = 0xFF;
+        for (unsigned i = 0; i < 64; i++)
+            result[(uint8_t)base64Alphabet[i]] = i;
+        return result;
+    }();
+
+    #if defined(__SSSE3__)
+        /* Digit values of 16 hexadecimal characters, invalid is set for lanes that are not digits. */
+        inline __m128i hexValues(__m128i chars, __m128i &invalid) {
+            __m128i digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+            __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+            __m128i alpha = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+            __m128i isAlpha = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+            invalid = _mm_or_si128(invalid, _mm_xor_si128(_mm_or_si128(isDigit, isAlpha), _mm_set1_epi8((char)0xFF)));
+            return _mm_or_si128(
+                _mm_and_si128(isDigit, digit),
+                _mm_and_si128(isAlpha, _mm_add_epi8(alpha, _mm_set1_epi8(10)))
+            );
+        }
+
+        /* Muła's base64 encoding, the low 12 bytes of the input become 16 characters. */
+        inline __m128i base64Encode(__m128i input) {
+            input = _mm_shuffle_epi8(input, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+            __m128i indices = _mm_or_si128(
+                _mm_mulhi_epu16(_mm_and_si128(input, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040)),
+                _mm_mullo_epi16(_mm_and_si128(input, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010))
+            );
+            __m128i offset = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+            offset = _mm_or_si128(offset, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+            const __m128i shift = _mm_setr_epi8(
+                'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0
+            );
+            return _mm_add_epi8(_mm_shuffle_epi8(shift, offset), indices);
+        }
+
+        /* Decodes 16 base64 characters into the low 12 bytes of the result.
+            Characters are classified by their nibbles, invalid is set for lanes outside the alphabet.
+        */
+        inline __m128i base64Decode(__m128i chars, __m128i &invalid) {
+            const __m128i lutLo = _mm_setr_epi8(
+                0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A
+            );
+            const __m128i lutHi = _mm_setr_epi8(
+                0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+            );
+            const __m128i lutRoll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+            const __m128i mask = _mm_set1_epi8(0x2F);
+            __m128i hi = _mm_and_si128(_mm_srli_epi32(chars, 4), mask);
+            __m128i classes = _mm_and_si128(_mm_shuffle_epi8(lutLo, _mm_and_si128(chars, mask)), _mm_shuffle_epi8(lutHi, hi));
+            invalid = _mm_or_si128(invalid, classes);
+            __m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(_mm_cmpeq_epi8(chars, mask), hi));
+            __m128i values = _mm_add_epi8(chars, roll);
+            values = _mm_madd_epi16(_mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140)), _mm_set1_epi32(0x00011000));
+            return _mm_shuffle_epi8(values, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        }
+    #endif
+
+    #if defined(__AVX2__)
+        inline __m256i hexValues(__m256i chars, __m256i &invalid) {
+            __m256i digit = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+            __m256i isDigit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+            __m256i alpha = _mm256_sub_epi8(_mm256_or_si256(chars, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+            __m256i isAlpha = _mm256_cmpeq_epi8(_mm256_min_epu8(alpha, _mm256_set1_epi8(5)), alpha);
+            invalid = _mm256_or_si256(invalid, _mm256_xor_si256(_mm256_or_si256(isDigit, isAlpha), _mm256_set1_epi8((char)0xFF)));
+            return _mm256_or_si256(
+                _mm256_and_si256(isDigit, digit),
+                _mm256_and_si256(isAlpha, _mm256_add_epi8(alpha, _mm256_set1_epi8(10)))
+            );
+        }
+    #endif
+
+    const uint8_t *encodeHexBlocks(const uint8_t *ptr, [[maybe_unused]] const uint8_t *end, [[maybe_unused]] char *&out, [[maybe_unused]] const char *digits) {
+        #if defined(__AVX2__)
+            const __m256i lut = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)digits));
+            for (; end - ptr >= 32; ptr += 32, out += 64) {
+                __m256i input = _mm256_loadu_si256((const __m256i*)ptr);
+                __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(input, 4), _mm256_set1_epi8(0x0F)));
+                __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(input, _mm256_set1_epi8(0x0F)));
+                __m256i first = _mm256_unpacklo_epi8(hi, lo), second = _mm256_unpackhi_epi8(hi, lo);
+                _mm256_storeu_si256((__m256i*)out, _mm256_permute2x128_si256(first, second, 0x20));
+                _mm256_storeu_si256((__m256i*)out + 1, _mm256_permute2x128_si256(first, second, 0x31));
+            }
+        #endif
+        #if defined(__SSSE3__)
+            const __m128i lut128 = _mm_loadu_si128((const __m128i*)digits);
+            for (; end - ptr >= 16; ptr += 16, out += 32) {
+                __m128i input = _mm_loadu_si128((const __m128i*)ptr);
+                __m128i hi = _mm_shuffle_epi8(lut128, _mm_and_si128(_mm_srli_epi16(input, 4), _mm_set1_epi8(0x0F)));
+                __m128i lo = _mm_shuffle_epi8(lut128, _mm_and_si128(input, _mm_set1_epi8(0x0F)));
+                _mm_storeu_si128((__m128i*)out, _mm_unpacklo_epi8(hi, lo));
+                _mm_storeu_si128((__m128i*)out + 1, _mm_unpackhi_epi8(hi, lo));
+            }
+        #endif
+        return ptr;
+    }
+
+    /* Advances ptr past the converted input, returns false if a character is not a digit. */
+    bool decodeHexBlocks([[maybe_unused]] const char *&ptr, [[maybe_unused]] const char *end, [[maybe_unused]] uint8_t *&out) {
+        #if defined(__AVX2__)
+            __m256i invalid = _mm256_setzero_si256();
+            for (; end - ptr >= 64; ptr += 64, out += 32) {
+                __m256i first = _mm256_maddubs_epi16(
+                    hexValues(_mm256_loadu_si256((const __m256i*)ptr), invalid), _mm256_set1_epi16(0x0110)
+                );
+                __m256i second = _mm256_maddubs_epi16(
+                    hexValues(_mm256_loadu_si256((const __m256i*)ptr + 1), invalid), _mm256_set1_epi16(0x0110)
+                );
+                _mm256_storeu_si256((__m256i*)out, _mm256_permute4x64_epi64(_mm256_packus_epi16(first, second), 0xD8));
+            }
+            if (!_mm256_testz_si256(invalid, invalid))
+                return false;
+        #endif
+        #if defined(__SSSE3__)
+            __m128i invalid128 = _mm_setzero_si128();
+            for (; end - ptr >= 32; ptr += 32, out += 16) {
+                __m128i first = _mm_maddubs_epi16(hexValues(_mm_loadu_si128((const __m128i*)ptr), invalid128), _mm_set1_epi16(0x0110));
+                __m128i second = _mm_maddubs_epi16(hexValues(_mm_loadu_si128((const __m128i*)ptr + 1), invalid128), _mm_set1_epi16(0x0110));
+                _mm_storeu_si128((__m128i*)out, _mm_packus_epi16(first, second));
+            }
+            if (_mm_movemask_epi8(invalid128))
+                return false;
+        #endif
+        return true;
+    }
+
+    const uint8_t *encodeBase64Blocks(const uint8_t *ptr, [[maybe_unused]] const uint8_t *end, [[maybe_unused]] char *&out) {
+        // Every block loads 16 bytes of which 12 are encoded.
+        #if defined(__AVX2__)
+            for (; end - ptr >= 28; ptr += 24, out += 32) {
+                __m128i first = base64Encode(_mm_loadu_si128((const __m128i*)ptr));
+                __m128i second = base64Encode(_mm_loadu_si128((const __m128i*)(ptr + 12)));
+                _mm256_storeu_si256((__m256i*)out, _mm256_set_m128i(second, first));
+            }
+        #endif
+        #if defined(__SSSE3__)
+            for (; end - ptr >= 16; ptr += 12, out += 16)
+                _mm_storeu_si128((__m128i*)out, base64Encode(_mm_loadu_si128((const __m128i*)ptr)));
+        #endif
+        return ptr;
+    }
+
+    /* Advances ptr past the converted input, returns false if a character is outside the alphabet.
+        Every block stores 16 bytes of which 12 are decoded, so out must have room for 4 bytes past them.
+    */
+    bool decodeBase64Blocks([[maybe_unused]] const char *&ptr, [[maybe_unused]] const char *end, [[maybe_unused]] uint8_t *&out) {
+        #if defined(__SSSE3__)
+            __m128i invalid = _mm_setzero_si128();
+            for (; end - ptr >= 24; ptr += 16, out += 12)
+                _mm_storeu_si128((__m128i*)out, base64Decode(_mm_loadu_si128((const __m128i*)ptr), invalid));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(invalid, _mm_setzero_si128())) != 0xFFFF)
+                return false;
+        #endif
+        return true;
+    }
+};
+
+void ktu::encode_hex(view input, buffer &out, bool uppercase) {
+    const char *digits = (uppercase) ? hexUpper : hexLower;
+    const uint8_t *ptr = input.begin(), *end = input.end();
+    char *dst = out.grow<char>(encoded_hex_size(input.size()));
+    ptr = encodeHexBlocks(ptr, end, dst, digits);
+    for (; ptr < end; ptr++) {
+        *dst++ = digits[*ptr >> 4];
+        *dst++ = digits[*ptr & 0xF];
+    }
+}
+
+bool ktu::decode_hex(view input, buffer &out) {
+    if (input.size() % 2)
+        return false;
+    size_t size = out.size();
+    const char *ptr = input.begin<char>(), *end = input.end<char>();
+    uint8_t *dst = out.grow(input.size() / 2);
+    if (decodeHexBlocks(ptr, end, dst)) {
+        for (; ptr < end; ptr += 2) {
+            uint8_t hi = charclass::digit[(uint8_t)ptr[0]], lo = charclass::digit[(uint8_t)ptr[1]];
+            if ((hi | lo) >= 16)
+                break;
+            *dst++ = (hi << 4) | lo;
+        }
+        if (ptr == end)
+            return true;
+    }
+    out.resize(size);
+    return false;
+}
+
+void ktu::encode_base64(view input, buffer &out) {
+    const uint8_t *ptr = input.begin(), *end = input.end();
+    char *dst = out.grow<char>(encoded_base64_size(input.size()));
+    ptr = encodeBase64Blocks(ptr, end, dst);
+    for (; end - ptr >= 3; ptr += 3) {
+        uint32_t value = (ptr[0] << 16) | (ptr[1] << 8) | ptr[2];
+        *dst++ = base64Alphabet[value >> 18];
+        *dst++ = base64Alphabet[(value >> 12) & 0x3F];
+        *dst++ = base64Alphabet[(value >> 6) & 0x3F];
+        *dst++ = base64Alphabet[value & 0x3F];
+    }
+    if (ptr == end)
+        return;
+    uint32_t value = ptr[0] << 16;
+    if (end - ptr == 2)
+        value |= ptr[1] << 8;
+    *dst++ = base64Alphabet[value >> 18];
+    *dst++ = base64Alphabet[(value >> 12) & 0x3F];
+    *dst++ = (end - ptr == 2) ? base64Alphabet[(value >> 6) & 0x3F] : '=';
+    *dst++ = '=';
+}
+
+bool ktu::decode_base64(view input, buffer &out) {
+    const char *ptr = input.begin<char>(), *end = input.end<char>();
+    if (input.size() % 4 == 0 && input.size()) {
+        end -= (end[-1] == '=');
+        end -= (end[-1] == '=');
+    }
+    size_t chars = end - ptr;
+    if (chars % 4 == 1)
+        return false;
+    size_t size = out.size(), decoded = chars / 4 * 3 + ((chars % 4) ? chars % 4 - 1 : 0);
+    // Blocks store 4 bytes past the bytes they decode.
+    out.reserve(size + decoded + 4);
+    uint8_t *dst = out.grow(decoded);
+    if (decodeBase64Blocks(ptr, end, dst)) {
+        uint32_t value = 0;
+        unsigned count = 0;
+        for (; ptr < end; ptr++) {
+            uint8_t digit = base64Digit[(uint8_t)*ptr];
+            if (digit >= 64)
+                break;
+            value = (value << 6) | digit;
+            if (++count == 4) {
+                *dst++ = value >> 16;
+                *dst++ = value >> 8;
+                *dst++ = value;
+                value = count = 0;
+            }
+        }
+        if (ptr == end) {
+            if (count == 2) {
+                *dst++ = value >> 4;
+            } else if (count == 3) {
+                *dst++ = value >> 10;
+                *dst++ = value >> 2;
+            }
+            return true;
+        }
+    }
+    out.resize(size);
+    return false;
+}
@@ -1,6 +1,15 @@
 #include <ktu/memory/file.hpp>
 #include <fstream>
 #include <iterator>
+#include <algorithm>
+#include <vector>
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
 void ktu::file::write(const std::filesystem::path &path, char *first, char *last) {
     if (path.has_parent_path() && !std::filesystem::exists(path))
         std::filesystem::create_directories(path.parent_path());
@@ -16,4 +25,55 @@ void ktu::file::read(const std::filesystem::path &path, void *dst, size_t filesi
     char buffer [256 * 1024];
     f.rdbuf()->pubsetbuf(buffer, sizeof(buffer));
     f.read((char*)dst, filesize);
-}
\ No newline at end of file
+}
+
+bool ktu::file::write(const std::filesystem::path &path, std::initializer_list<std::pair<const void*, size_t>> parts) {
+    if (path.has_parent_path() && !std::filesystem::exists(path))
+        std::filesystem::create_directories(path.parent_path());
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return false;
+    std::vector<iovec> iov;
+    for (auto [data, size] : parts) {
+        if (size)
+            iov.push_back(iovec{(void*)data, size});
+    }
+    // A single writev may stop short, at about 2 GiB on Linux, so it continues from where it stopped.
+    for (size_t i = 0; i < iov.size();) {
+        ssize_t written = ::writev(fd, iov.data() + i, std::min(iov.size() - i, (size_t)IOV_MAX));
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            ::close(fd);
+            return false;
+        }
+        for (; i < iov.size() && (size_t)written >= iov[i].iov_len; ++i)
+            written -= iov[i].iov_len;
+        if (written) {
+            iov[i].iov_base = (char*)iov[i].iov_base + written;
+            iov[i].iov_len -= written;
+        }
+    }
+    return !::close(fd);
+}
+
+
+ktu::file::mapping::mapping(const std::filesystem::path &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+    struct stat st;
+    if (!::fstat(fd, &st) && st.st_size > 0) {
+        void *data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            priv.data = data;
+            priv.size = st.st_size;
+        }
+    }
+    ::close(fd);
+}
+
+ktu::file::mapping::~mapping() {
+    if (priv.data)
+        ::munmap(priv.data, priv.size);
+}
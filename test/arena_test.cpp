@@ -0,0 +1,132 @@
+#include <ktu/multi_string.hpp>
+#include <string>
+#include <vector>
+#include "check.hpp"
+
+template <class MultiString>
+static void equal(const MultiString &strings, const std::vector<std::string> &model) {
+    CHECK(strings.size() == model.size());
+    for (size_t i = 0; i < model.size(); ++i)
+        CHECK(strings[i] == model[i]);
+}
+
+/* Edits that relocate a substring behind the others, the garbage they leave and the compactions that drop it. */
+template <class MultiString>
+static void relocations() {
+    MultiString strings;
+    strings.arena_mode(true);
+    std::vector<std::string> model = {"aaaa", "bbbbbbbb", "", "cc"};
+    for (const std::string &s : model)
+        strings.push_back(s);
+    strings.building_push_back('z');
+
+    // Empty substrings may end where the last one does, so it is copied once before its first edit, then edited in place.
+    strings.substring_append(strings.begin() + 3, "C");
+    model[3] += "C";
+    equal(strings, model);
+    CHECK(strings.garbage_size() == 2);
+    strings.substring_append(strings.begin() + 3, "D");
+    model[3] += "D";
+    equal(strings, model);
+    CHECK(strings.garbage_size() == 2);
+    // A substring before it is copied behind the others, its old characters are garbage.
+    strings.substring_push_back(strings.begin(), 'A');
+    model[0] += 'A';
+    equal(strings, model);
+    CHECK(strings.garbage_size() == 6);
+    // Editing it again finds it already last.
+    strings.substring_erase(strings.begin(), 0, 2);
+    model[0].erase(0, 2);
+    equal(strings, model);
+    CHECK(strings.garbage_size() == 6);
+    // An empty substring leaves no garbage behind.
+    strings.substring_insert(strings.begin() + 2, 0, "e");
+    model[2] = "e";
+    equal(strings, model);
+    CHECK(strings.garbage_size() == 6 && strings.building_string_view() == "z");
+
+    // A relocation that would leave garbage over half of the string compacts first.
+    // The eight characters of the cleared substring therefore do not all stay behind.
+    strings.substring_clear(strings.begin() + 1);
+    model[1].clear();
+    equal(strings, model);
+    strings.substring_append(strings.begin() + 3, "x");
+    model[3] += "x";
+    equal(strings, model);
+    CHECK(strings.garbage_size() < 6 + 8);
+    CHECK(strings.building_string_view() == "z");
+
+    // Nodes inserted and erased around relocated substrings keep their order.
+    strings.insert(strings.begin() + 1, "new");
+    model.insert(model.begin() + 1, "new");
+    strings.erase(strings.begin() + 3);
+    model.erase(model.begin() + 3);
+    strings.pop_back();
+    model.pop_back();
+    equal(strings, model);
+
+    strings.compact();
+    CHECK(strings.garbage_size() == 0);
+    equal(strings, model);
+    std::string cumulative;
+    for (const std::string &s : model)
+        cumulative += s;
+    CHECK(std::string(strings.cumulative_c_str()) == cumulative);
+    strings.substring_push_back(strings.begin(), '!');
+    model[0] += '!';
+    strings.arena_mode(false);
+    CHECK(strings.garbage_size() == 0);
+    equal(strings, model);
+}
+
+int main() {
+    {
+        // Shrinking the substring in front of the building substring used to leave the empty node after it behind.
+        ktu::multi_string strings;
+        strings.arena_mode(true);
+        strings.push_back("a");
+        strings.push_back("bb");
+        strings.push_back("");
+        strings.substring_erase(strings.begin() + 1, 0, 1);
+        CHECK(strings[0] == "a" && strings[1] == "b" && strings[2] == "");
+        CHECK((strings.begin() + 2).index() <= strings.cumulative_size() - strings.building_size());
+        strings.compact();
+        CHECK(strings[0] == "a" && strings[1] == "b" && strings[2] == "");
+        CHECK(std::string(strings.cumulative_c_str()) == "ab");
+    }
+    {
+        // The same with an empty substring inserted before it.
+        ktu::multi_string strings;
+        strings.arena_mode(true);
+        strings.push_back("a");
+        strings.insert(strings.begin(), "");
+        strings.substring_erase(strings.begin() + 1, 0, 1);
+        strings.compact();
+        CHECK(strings.size() == 2 && strings[0] == "" && strings[1] == "");
+    }
+    {
+        // Iterator edits of a substring that is not last move the iterator along with the copy of the substring.
+        ktu::multi_string strings;
+        strings.arena_mode(true);
+        for (const char *s : {"one", "two", "three"})
+            strings.push_back(s);
+        auto it = strings.substring_insert(strings.begin() + 1, strings.cumulative_cbegin() + 4, 'W');
+        CHECK(*it == 'W' && strings[1] == "tWwo");
+        it = strings.substring_insert(strings.begin(), strings.cumulative_cbegin() + 3, 2, '!');
+        CHECK(*it == '!' && strings[0] == "one!!");
+        std::string tail = "xy";
+        it = strings.substring_insert(strings.begin() + 1, strings.cumulative_cbegin() + (strings.begin() + 1).index(), tail.begin(), tail.end());
+        CHECK(*it == 'x' && strings[1] == "xytWwo");
+        it = strings.substring_insert(strings.begin(), strings.cumulative_cbegin() + strings.begin().index() + 1, {'-', '-'});
+        CHECK(*it == '-' && strings[0] == "o--ne!!");
+        it = strings.substring_erase(strings.begin() + 1, strings.cumulative_cbegin() + (strings.begin() + 1).index() + 2);
+        CHECK(*it == 'W' && strings[1] == "xyWwo");
+        equal(strings, {"o--ne!!", "xyWwo", "three"});
+        strings.compact();
+        equal(strings, {"o--ne!!", "xyWwo", "three"});
+        CHECK(std::string(strings.cumulative_c_str()) == "o--ne!!xyWwothree");
+    }
+    relocations<ktu::multi_string>();
+    relocations<ktu::multi_string32>();
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include <ktu/charclass.hpp>
+#include <algorithm>
+#include <cctype>
+#include <memory>
+#include <string>
+#include "check.hpp"
+
+/* A scanner with the <cctype> predicate it has to agree with and a byte of its class. */
+struct scanner {
+    const char *(*scan)(const char*, const char*);
+    bool (*expected)(unsigned char);
+    char member;
+};
+
+int main() {
+    // Every byte, including those above 0x7F that used to index the tables with negative values.
+    for (unsigned c = 0; c < 256; ++c) {
+        char ch = (char)c;
+        CHECK(ktu::isDec(ch) == bool(std::isdigit(c)));
+        CHECK(ktu::isHex(ch) == bool(std::isxdigit(c)));
+        CHECK(ktu::isOct(ch) == (c >= '0' && c <= '7'));
+        CHECK(ktu::isBin(ch) == (c == '0' || c == '1'));
+        CHECK(ktu::isSpace(ch) == bool(std::isspace(c)));
+        CHECK(ktu::isVariableStart(ch) == (std::isalpha(c) || c == '_'));
+        CHECK(ktu::isVariable(ch) == (std::isalnum(c) || c == '_'));
+        unsigned value = std::isdigit(c) ? c - '0' : std::isxdigit(c) ? std::tolower(c) - 'a' + 10 : 0xFF;
+        CHECK(ktu::charclass::digit[c] == value);
+        const char *ptr = &ch;
+        CHECK(ktu::readHex(ptr, 1) == (value == 0xFF ? 0 : value) && ptr == &ch + (value != 0xFF));
+    }
+
+    const scanner scanners[] = {
+        {ktu::scanBin, [](unsigned char c) {return c == '0' || c == '1';}, '1'},
+        {ktu::scanOct, [](unsigned char c) {return c >= '0' && c <= '7';}, '7'},
+        {ktu::scanDec, [](unsigned char c) {return bool(std::isdigit(c));}, '9'},
+        {ktu::scanHex, [](unsigned char c) {return bool(std::isxdigit(c));}, 'F'},
+        {ktu::scanSpace, [](unsigned char c) {return bool(std::isspace(c));}, '\v'},
+        {ktu::scanVariable, [](unsigned char c) {return std::isalnum(c) || c == '_';}, '_'},
+    };
+    for (const scanner &s : scanners) {
+        // Each byte ending a run at every position of the first and second block and in the tail.
+        for (size_t length : {0, 1, 15, 16, 17, 31, 32, 40}) {
+            for (unsigned c = 0; c < 256; ++c) {
+                std::string input = std::string(length, s.member) + (char)c + std::string(20, s.member);
+                const char *first = input.data(), *last = first + input.size();
+                const char *end = s.scan(first, last);
+                if (s.scan == ktu::scanVariable && !length)
+                    CHECK(end == (std::isalpha(c) || c == '_' ? last : first));
+                else
+                    CHECK(end == (s.expected(c) ? last : first + length));
+            }
+        }
+        // A bound inside a block stops the scan, the allocation ends at the bound so sanitizers catch reads past it.
+        for (size_t bound = 0; bound <= 64; ++bound) {
+            std::unique_ptr<char[]> run(new char[bound]);
+            std::fill_n(run.get(), bound, s.member);
+            CHECK(s.scan(run.get(), run.get() + bound) == run.get() + bound);
+        }
+    }
+    std::string digits = "9abc";
+    CHECK(ktu::scanVariable(digits.data(), digits.data() + digits.size()) == digits.data());
+    return 0;
+}
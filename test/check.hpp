@@ -0,0 +1,7 @@
+#pragma once
+#include <iostream>
+#include <cstdlib>
+
+/* Stops the test with the failed condition and its location. */
+#define CHECK(__Condition) \
+    do {if (!(__Condition)) {std::cout << __FILE__ << ':' << __LINE__ << ": " << #__Condition << '\n'; exit(-1);}} while(0)
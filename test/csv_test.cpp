@@ -0,0 +1,98 @@
+#include <ktu/csv.hpp>
+#include <random>
+#include <string>
+#include <vector>
+#include "check.hpp"
+
+struct expected {
+    std::string value;
+    bool quoted;
+    bool last;
+};
+
+// Byte at a time reference of the same rules.
+static std::vector<expected> reference(const std::string &input, char delimiter = ',', char quote = '"') {
+    std::vector<expected> fields;
+    size_t start = 0;
+    bool inside = false;
+    auto emit = [&](size_t end, bool last) {
+        if (last && end > start && input[end - 1] == '\r')
+            --end;
+        std::string field = input.substr(start, end - start);
+        expected e{field, false, last};
+        if (quote && !field.empty() && field.front() == quote) {
+            e.quoted = true;
+            field.erase(0, 1);
+            if (!field.empty() && field.back() == quote)
+                field.pop_back();
+            e.value.clear();
+            for (size_t i = 0; i < field.size(); ++i) {
+                e.value.push_back(field[i]);
+                if (field[i] == quote && i + 1 < field.size() && field[i + 1] == quote)
+                    ++i;
+            }
+        }
+        fields.push_back(e);
+    };
+    bool trailing = false;
+    for (size_t i = 0; i < input.size(); ++i) {
+        if (quote && input[i] == quote)
+            inside = !inside;
+        else if (!inside && (input[i] == delimiter || input[i] == '\n')) {
+            emit(i, input[i] == '\n');
+            start = i + 1;
+            trailing = input[i] != '\n';
+        }
+    }
+    if (start < input.size() || trailing)
+        emit(input.size(), true);
+    return fields;
+}
+
+static void compare(const std::string &input, char delimiter = ',', char quote = '"') {
+    std::vector<expected> fields = reference(input, delimiter, quote);
+    ktu::csv::tokenizer tokenizer(ktu::view(input.data(), input.size()), delimiter, quote);
+    size_t i = 0;
+    for (const ktu::csv::field &field : tokenizer) {
+        CHECK(i < fields.size());
+        CHECK(ktu::csv::unescape(field, quote ? quote : '"') == fields[i].value);
+        CHECK(field.quoted == fields[i].quoted);
+        CHECK(field.last == fields[i].last);
+        ++i;
+    }
+    CHECK(i == fields.size());
+}
+
+int main() {
+    {
+        std::string input = "a,\"b,c\",\"say \"\"hi\"\"\"\r\n,\n";
+        ktu::csv::tokenizer tokenizer(ktu::view(input.data(), input.size()));
+        CHECK(tokenizer.next() && tokenizer.get().string_view() == "a" && !tokenizer.get().quoted);
+        CHECK(tokenizer.next() && tokenizer.get().string_view() == "b,c" && tokenizer.get().quoted && !tokenizer.get().escaped);
+        CHECK(tokenizer.next() && tokenizer.get().escaped && tokenizer.get().last);
+        CHECK(ktu::csv::unescape(tokenizer.get()) == "say \"hi\"");
+        CHECK(tokenizer.next() && tokenizer.get().size() == 0 && !tokenizer.get().last);
+        CHECK(tokenizer.next() && tokenizer.get().size() == 0 && tokenizer.get().last);
+        CHECK(!tokenizer.next());
+    }
+    compare("");
+    compare("a");
+    compare("a,");
+    compare("a\n");
+    compare("\"unterminated,\nfield");
+    // Quotes and delimiters on both sides of the 64 byte blocks.
+    for (size_t pad = 55; pad < 140; ++pad) {
+        compare(std::string(pad, 'x') + "\"q,\n\"\"q\",y\r\nz");
+        compare(std::string(pad, 'x') + ",\"" + std::string(70, ',') + "\",end");
+    }
+    std::mt19937 rng(7);
+    const char alphabet[] = {'a', ',', '"', '\n', '\r', '\t'};
+    for (size_t round = 0; round < 2000; ++round) {
+        std::string input(rng() % 300, ' ');
+        for (char &c : input)
+            c = alphabet[rng() % sizeof(alphabet)];
+        compare(input);
+        compare(input, '\t', 0);
+    }
+    return 0;
+}
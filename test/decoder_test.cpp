@@ -0,0 +1,117 @@
+#include <ktu/memory.hpp>
+#include <random>
+#include <string>
+#include <vector>
+#include "check.hpp"
+
+using fmtflags = ktu::buf_io::fmtflags;
+
+static ktu::buffer decode(const std::string &input, long flags) {
+    ktu::buffer buf;
+    buf.input(input, flags);
+    return buf;
+}
+
+/* Feeds the input in the given pieces, checking measure against what each feed appends. */
+static ktu::buffer feed(const std::string &input, long flags, const std::vector<size_t> &cuts) {
+    ktu::buffer buf;
+    ktu::buffer::decoder decoder(flags);
+    size_t prev = 0;
+    for (size_t i = 0; i <= cuts.size(); ++i) {
+        size_t cut = (i < cuts.size()) ? cuts[i] : input.size();
+        size_t size = buf.size(), measured = decoder.measure(input.data() + prev, cut - prev);
+        decoder.feed(buf, input.data() + prev, cut - prev);
+        CHECK(buf.size() - size == measured);
+        prev = cut;
+    }
+    decoder.finish(buf);
+    return buf;
+}
+
+static void compare(const std::string &input, long flags) {
+    ktu::buffer whole = decode(input, flags);
+    CHECK(whole.size() == ktu::buffer::decoder(flags).measure(input.data(), input.size(), true));
+    for (size_t cut = 0; cut <= input.size(); ++cut)
+        CHECK(feed(input, flags, {cut}) == whole);
+    std::vector<size_t> bytes;
+    for (size_t cut = 1; cut < input.size(); ++cut)
+        bytes.push_back(cut);
+    CHECK(feed(input, flags, bytes) == whole);
+}
+
+int main() {
+    const long encodings[] = {
+        fmtflags::numeric, fmtflags::ascii, fmtflags::latin_1, fmtflags::utf_8,
+        fmtflags::utf_16le, fmtflags::utf_16be, fmtflags::utf_32le, fmtflags::utf_32be
+    };
+    const long bases[] = {fmtflags::hex, fmtflags::dec, fmtflags::oct, fmtflags::bin};
+    for (long encoding : encodings) {
+        for (long base : bases) {
+            long flags = encoding | base | fmtflags::fmt;
+            CHECK(decode("", flags).size() == 0);
+            CHECK(feed("", flags, {}).size() == 0);
+            CHECK(feed("", flags, {0, 0}).size() == 0);
+        }
+    }
+
+    CHECK(decode("48656c6c6f", fmtflags::fmt) == decode("[[ascii]]Hello", fmtflags::fmt));
+    CHECK(decode("[[dec]]72 101 108 108 111", fmtflags::fmt) == decode("Hello", fmtflags::ascii | fmtflags::fmt));
+    {
+        ktu::buffer buf = decode("\\[a\\\\[1 2 ff]\xC3\xA9", fmtflags::utf_8 | fmtflags::fmt);
+        CHECK(buf.size() == 8);
+        CHECK(std::string((const char*)buf.data(), 4) == "[a\\\x01");
+    }
+
+    // Directives nested in brackets or in other directives, the bytes are those of the parser before the decoder.
+    struct nested {
+        std::string input, numeric, ascii;
+    };
+    const nested nestings[] = {
+        {"[[ascii]]Hi[1 2]", "Hi\x01\x02", "Hi\x01\x02"},
+        {"[1 [[dec]] 255 2]", "\xFF\x02", "\x01 255 2]"},
+        {"[[hex [[dec]] 255]] 10", "\xFF\x0A", " 255]] 10"},
+        {"[[dec][oct]] 10", "\x08", " 10"},
+        {"[[ascii [hex]]]41", "]41", "]41"},
+        {"[[[ascii]]]A", "]A", "]A"},
+        {"[1 [2 3] 4]", "", "\x01\x04"},
+        {"[[dec]]1[[hex]]1", "\x01\x01", "11"},
+        {"[[ascii]] [41 [[dec]] 65] x", " A 65] x", " A 65] x"},
+        {"[[utf_8]][[ascii]]A", "A", "A"},
+        {"[ff [[dec]] 10] 10", "\x0A\x0A", "\xFF 10] 10"},
+    };
+    for (const nested &n : nestings) {
+        ktu::buffer numeric = decode(n.input, fmtflags::numeric | fmtflags::fmt), ascii = decode(n.input, fmtflags::ascii | fmtflags::fmt);
+        CHECK(std::string((const char*)numeric.data(), numeric.size()) == n.numeric);
+        CHECK(std::string((const char*)ascii.data(), ascii.size()) == n.ascii);
+    }
+
+    std::vector<std::string> inputs = {
+        "0123456789abcdef fedcba 7 0 1",
+        "[[hex]]ff0 1[[dec]]255 3[[oct]]377[[bin]]11111111 101",
+        "plain [1 2 3] text \\[ \\\\ \\x [[utf_8]]\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80 \xFF\xC3",
+        "[[utf_16be]]ab[[utf_32le]]cd[[latin_1]]\xE9\xA0\x7F[[ascii]]\xC3\xA9\\\xC3\xA9",
+        "[[numeric]]12 34 [[ascii]] [56] 7",
+        "[unterminated [[hex",
+        "\xE2\x82",
+        "1",
+    };
+    std::mt19937 rng(29);
+    const std::string alphabet = "0123456789abcdef []\\\n\xC3\xA9\xE2";
+    const char *directives[] = {"[[hex]]", "[[dec]]", "[[bin]]", "[[utf_8]]", "[[utf_16le]]", "[[ascii]]", "[[numeric]]"};
+    for (size_t i = 0; i < 40; ++i) {
+        std::string input;
+        for (size_t length = rng() % 60; length; --length) {
+            if (!(rng() % 12))
+                input += directives[rng() % std::size(directives)];
+            else
+                input += alphabet[rng() % alphabet.size()];
+        }
+        inputs.push_back(input);
+    }
+    for (const nested &n : nestings)
+        inputs.push_back(n.input);
+    for (const std::string &input : inputs)
+        for (long encoding : encodings)
+            compare(input, encoding | fmtflags::fmt);
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include <ktu/memory.hpp>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include "check.hpp"
+
+static std::string dump(const std::string &input) {
+    std::ostringstream os;
+    ktu::buf_io::dump(os, input.data(), input.size());
+    return os.str();
+}
+
+static std::string dumpFd(const std::string &input) {
+    FILE *file = std::tmpfile();
+    CHECK(file && ktu::buf_io::dump(fileno(file), input.data(), input.size()));
+    std::string text;
+    char block[4096];
+    std::rewind(file);
+    for (size_t count; (count = std::fread(block, 1, sizeof(block), file));)
+        text.append(block, count);
+    std::fclose(file);
+    return text;
+}
+
+/* Checks both variants against the output of hexdump -C for the same bytes. */
+static void expect(const std::string &input, const std::string &text) {
+    CHECK(dump(input) == text);
+    CHECK(dumpFd(input) == text);
+}
+
+int main() {
+    expect("", "");
+
+    // A partial final row pads the hexadecimal columns, its ascii column is only as long as the row.
+    expect(std::string("Hello, world!\n\x00\x01" "abc", 19),
+        "00000000  48 65 6c 6c 6f 2c 20 77  6f 72 6c 64 21 0a 00 01  |Hello, world!...|\n"
+        "00000010  61 62 63                                          |abc|\n"
+        "00000013\n"
+    );
+    expect(std::string(9, '\x7F'),
+        "00000000  7f 7f 7f 7f 7f 7f 7f 7f  7f                       |.........|\n"
+        "00000009\n"
+    );
+
+    // Rows equal to the one before collapse into a single '*', the final offset still counts them.
+    expect(std::string(64, '\0') + "x",
+        "00000000  00 00 00 00 00 00 00 00  00 00 00 00 00 00 00 00  |................|\n"
+        "*\n"
+        "00000040  78                                                |x|\n"
+        "00000041\n"
+    );
+    expect(std::string(48, 'A'),
+        "00000000  41 41 41 41 41 41 41 41  41 41 41 41 41 41 41 41  |AAAAAAAAAAAAAAAA|\n"
+        "*\n"
+        "00000030\n"
+    );
+    // A partial row is never collapsed, and a row after a different one is written again.
+    std::string a(16, 'a'), b = "0123456789abcdef";
+    expect(a + a + b + a + "aaaa",
+        "00000000  61 61 61 61 61 61 61 61  61 61 61 61 61 61 61 61  |aaaaaaaaaaaaaaaa|\n"
+        "*\n"
+        "00000020  30 31 32 33 34 35 36 37  38 39 61 62 63 64 65 66  |0123456789abcdef|\n"
+        "00000030  61 61 61 61 61 61 61 61  61 61 61 61 61 61 61 61  |aaaaaaaaaaaaaaaa|\n"
+        "00000040  61 61 61 61                                       |aaaa|\n"
+        "00000044\n"
+    );
+    expect(std::string("\x80\xFF \x1F~", 5),
+        "00000000  80 ff 20 1f 7e                                    |.. .~|\n"
+        "00000005\n"
+    );
+
+    // Both variants agree on dumps larger than their output block.
+    std::string large(300 * 1024 + 7, '\0');
+    for (size_t i = 0; i < large.size(); ++i)
+        large[i] = (i / 4096 % 2) ? 'z' : (char)(i * 7);
+    std::string text = dump(large);
+    CHECK(dumpFd(large) == text);
+    CHECK(text.find("*\n") != std::string::npos && text.ends_with("\n0004b000  7a 7a 7a 7a 7a 7a 7a                              |zzzzzzz|\n0004b007\n"));
+    return 0;
+}
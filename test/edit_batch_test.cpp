@@ -0,0 +1,101 @@
+#include <ktu/multi_string.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "check.hpp"
+
+template <class MultiString>
+static void equal(const MultiString &strings, const std::vector<std::string> &model) {
+    CHECK(strings.size() == model.size());
+    for (size_t i = 0; i < model.size(); ++i)
+        CHECK(strings[i] == model[i]);
+}
+
+/* The same edits through a batch and one at a time give the same strings, in every layout and in arena mode. */
+template <class MultiString>
+static void layouts(bool arena) {
+    MultiString strings;
+    if constexpr (requires {strings.arena_mode(true);})
+        strings.arena_mode(arena);
+    strings.hash_index(true);
+    std::vector<std::string> model = {"", "a", "bb", "", "ccc", "dddd", "a", ""};
+    for (const std::string &s : model)
+        strings.push_back(s);
+    strings.building_push_back('z');
+    auto batch = strings.edit_batch();
+    // Empty substrings, the first and the last one, edits at the end of a substring and ones that remove it all.
+    batch.append(0, "x").insert(0, 0, "w").replace(2, 1, 1, "BBB").erase(4).append(4, "c").assign(7, "last");
+    batch.erase(5, 1, 2).insert(5, 2, "--").append(5, "").replace(1, 0, 5, "A");
+    model[0] = "wx";
+    model[2] = "bBBB";
+    model[4] = "c";
+    model[7] = "last";
+    model[5] = "dd--";
+    model[1] = "A";
+    batch.apply();
+    equal(strings, model);
+    std::string cumulative;
+    for (const std::string &s : model)
+        cumulative += s;
+    CHECK(std::string(strings.cumulative_c_str()) == cumulative + "z");
+    CHECK(strings.building_string_view() == "z");
+    // The hash index is rebuilt, the first of equal strings is found.
+    CHECK(strings.hash_index_valid() && strings.lookup("A") - strings.begin() == 1 && strings.lookup("a") - strings.begin() == 6);
+    CHECK(strings.lookup("") - strings.begin() == 3 && strings.lookup("ccc") == strings.end());
+
+    // A batch without edits changes nothing, and edits after apply go to the next one.
+    batch.apply();
+    equal(strings, model);
+    batch.append(3, "!");
+    batch.apply();
+    model[3] = "!";
+    equal(strings, model);
+    // Edits may be applied one at a time afterwards as usual.
+    strings.substring_append(strings.begin() + 3, "?");
+    model[3] += "?";
+    strings.push_back("new");
+    model.push_back("z" "new");
+    equal(strings, model);
+}
+
+int main() {
+    {
+        ktu::multi_string strings;
+        for (const char *s : {"hello", "", "world"})
+            strings.push_back(s);
+        auto batch = strings.edit_batch();
+        // Edits of the same node apply in the order they were added, each to the result of the ones before.
+        batch.append(0, " there").insert(0, 0, ">").replace(0, 1, 5, "HELLO").erase(0, 6, 1).append(2, "!").assign(1, "x").append(1, "y");
+        batch.apply();
+        equal(strings, {">HELLOthere", "xy", "world!"});
+        CHECK(std::string(strings.cumulative_c_str()) == ">HELLOtherexyworld!");
+
+        batch.append(2, "?");
+        batch.clear();
+        batch.apply();
+        equal(strings, {">HELLOthere", "xy", "world!"});
+
+        // An edit past the end of its substring throws before anything changes.
+        batch.append(0, "a").insert(1, 3, "b");
+        bool thrown = false;
+        try {
+            batch.apply();
+        } catch (const std::out_of_range &) {
+            thrown = true;
+        }
+        CHECK(thrown);
+        equal(strings, {">HELLOthere", "xy", "world!"});
+        thrown = false;
+        try {
+            batch.append(3, "c");
+        } catch (const std::out_of_range &) {
+            thrown = true;
+        }
+        CHECK(thrown);
+    }
+    layouts<ktu::multi_string>(false);
+    layouts<ktu::multi_string>(true);
+    layouts<ktu::multi_string32>(true);
+    layouts<ktu::packed_multi_string>(false);
+    return 0;
+}
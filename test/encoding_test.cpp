@@ -0,0 +1,94 @@
+#include <ktu/memory.hpp>
+#include <random>
+#include <string>
+#include "check.hpp"
+
+static std::string string(const ktu::buffer &buf) {
+    return std::string((const char*)buf.data(), buf.size());
+}
+
+static std::string referenceHex(const std::string &input) {
+    static const char digits[] = "0123456789abcdef";
+    std::string result;
+    for (unsigned char c : input) {
+        result.push_back(digits[c >> 4]);
+        result.push_back(digits[c & 0xF]);
+    }
+    return result;
+}
+
+static std::string referenceBase64(const std::string &input) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string result;
+    for (size_t i = 0; i < input.size(); i += 3) {
+        uint32_t value = (uint8_t)input[i] << 16;
+        if (i + 1 < input.size())
+            value |= (uint8_t)input[i + 1] << 8;
+        if (i + 2 < input.size())
+            value |= (uint8_t)input[i + 2];
+        result.push_back(alphabet[value >> 18]);
+        result.push_back(alphabet[(value >> 12) & 0x3F]);
+        result.push_back((i + 1 < input.size()) ? alphabet[(value >> 6) & 0x3F] : '=');
+        result.push_back((i + 2 < input.size()) ? alphabet[value & 0x3F] : '=');
+    }
+    return result;
+}
+
+static ktu::view view(const std::string &str) {
+    return ktu::view(str.data(), str.size());
+}
+
+int main() {
+    {
+        // Empty input is valid, and leaves out untouched.
+        ktu::buffer out;
+        CHECK(ktu::decode_hex(ktu::view(), out) && out.size() == 0);
+        CHECK(ktu::decode_base64(ktu::view(), out) && out.size() == 0);
+        CHECK(ktu::decode_hex(view(""), out) && out.size() == 0);
+        CHECK(ktu::decode_base64(view(""), out) && out.size() == 0);
+        ktu::encode_hex(ktu::view(), out);
+        ktu::encode_base64(ktu::view(), out);
+        CHECK(out.size() == 0);
+    }
+    {
+        ktu::buffer out;
+        CHECK(ktu::decode_base64(view("aGk"), out) && string(out) == "hi");
+        CHECK(!ktu::decode_base64(view("aGk=="), out) && string(out) == "hi");
+        CHECK(!ktu::decode_base64(view("a"), out));
+        CHECK(!ktu::decode_hex(view("abc"), out));
+        CHECK(ktu::decode_hex(view("DEADbeef"), out) && string(out) == "hi\xDE\xAD\xBE\xEF");
+        out.clear();
+        ktu::encode_hex(view("\xDE\xAD"), out, true);
+        CHECK(string(out) == "DEAD");
+    }
+    std::mt19937 rng(32);
+    for (size_t size = 0; size < 300; ++size) {
+        std::string input(size, '\0');
+        for (char &c : input)
+            c = (char)rng();
+
+        ktu::buffer hex, base64;
+        ktu::encode_hex(view(input), hex);
+        ktu::encode_base64(view(input), base64);
+        CHECK(string(hex) == referenceHex(input));
+        CHECK(string(base64) == referenceBase64(input));
+
+        ktu::buffer out;
+        CHECK(ktu::decode_hex(view(string(hex)), out) && string(out) == input);
+        out.clear();
+        CHECK(ktu::decode_base64(view(string(base64)), out) && string(out) == input);
+
+        // An invalid character anywhere, inside or after the blocks, fails and keeps out as it was.
+        if (size) {
+            std::string text = string(hex);
+            text[rng() % text.size()] = 'g';
+            out.clear();
+            out.push_back((uint8_t)1);
+            CHECK(!ktu::decode_hex(view(text), out) && out.size() == 1);
+            text = string(base64);
+            text[rng() % (text.size() - 2)] = '*';
+            CHECK(!ktu::decode_base64(view(text), out) && out.size() == 1);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include <ktu/string.hpp>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include "check.hpp"
+
+template <class T>
+static void compare(const std::string &input) {
+    const char *first = input.data(), *last = first + input.size();
+    T expected = 7, value = 7;
+    std::from_chars_result a = std::from_chars(first, last, expected);
+    std::from_chars_result b = ktu::parse_float(first, last, value);
+    CHECK(a.ec == b.ec);
+    CHECK(a.ptr == b.ptr);
+    CHECK(std::memcmp(&value, &expected, sizeof(T)) == 0 || (std::isnan(value) && std::isnan(expected)));
+}
+
+/* Formats the value and checks the text against std::to_chars and the value read back. */
+template <class T, class Bits>
+static void roundTrip(Bits bits) {
+    T value = std::bit_cast<T>(bits);
+    char a[64], b[64];
+    std::to_chars_result expected = std::to_chars(a, a + sizeof(a), value);
+    std::to_chars_result result = ktu::format_float(b, b + sizeof(b), value);
+    CHECK(result.ec == std::errc());
+    CHECK(std::string(a, expected.ptr) == std::string(b, result.ptr));
+    if (std::isnan(value))
+        return;
+    T parsed;
+    CHECK(ktu::parse_float(b, result.ptr, parsed).ec == std::errc());
+    CHECK(std::bit_cast<Bits>(parsed) == bits);
+}
+
+template <class T>
+static void random(std::mt19937_64 &rng) {
+    const std::string alphabet = "0123456789.eE-+";
+    for (size_t i = 0; i < 100000; ++i) {
+        std::string input;
+        if (rng() % 2) {
+            // Well formed numbers with up to 30 digits and exponents around the limits of the type.
+            if (rng() % 4 == 0)
+                input.push_back('-');
+            for (size_t digits = 1 + rng() % 30; digits; --digits)
+                input.push_back('0' + rng() % 10);
+            if (rng() % 2)
+                input.insert(input.size() - rng() % (input.size() - (input[0] == '-')), ".");
+            if (rng() % 2)
+                input += "e" + std::to_string((int)(rng() % 700) - 350);
+        } else {
+            for (size_t length = rng() % 12; length; --length)
+                input.push_back(alphabet[rng() % alphabet.size()]);
+        }
+        compare<T>(input);
+    }
+}
+
+int main() {
+    for (const char *input : {
+        "", "-", ".", "e5", "0", "-0", "1", "1.", ".5", "1e", "1e+", "1e5x", "0.1", "3.14159", "1e308", "1.7976931348623157e308",
+        "1.7976931348623159e308", "1e309", "4.9406564584124654e-324", "2.4703282292062328e-324", "1e-400", "3.4028235e38",
+        "3.4028236e38", "1.4e-45", "7e-46", "inf", "-Infinity", "infinit", "nan", "NaN(123)", "-nan", "nan(", "infx",
+        "9007199254740993", "123456789012345678901234567890", "0.000000000000000000000000000000000000000000001",
+        "2.2250738585072011e-308", "2.2250738585072014e-308", "1.00000000000000011102230246251565404236316680908203125",
+        "1.00000000000000011102230246251565404236316680908203124", "1.00000000000000011102230246251565404236316680908203126"
+    }) {
+        compare<double>(input);
+        compare<float>(input);
+    }
+    {
+        char text[4];
+        CHECK(ktu::format_float(text, text + sizeof(text), 0.125).ec == std::errc::value_too_large);
+        CHECK(ktu::format_float(text, text + sizeof(text), 0.5f).ec == std::errc());
+    }
+    for (double value : {0.0, -0.0, 1.0, 0.1, 1e21, 1e22, 1e-7, 123456.0, 5e-324, std::numeric_limits<double>::max(),
+        std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::quiet_NaN()})
+        roundTrip<double>(std::bit_cast<uint64_t>(value));
+    std::mt19937_64 rng(40);
+    for (size_t i = 0; i < 200000; ++i) {
+        roundTrip<double>((uint64_t)rng());
+        roundTrip<float>((uint32_t)rng());
+    }
+    random<double>(rng);
+    random<float>(rng);
+    return 0;
+}
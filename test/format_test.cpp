@@ -0,0 +1,98 @@
+#include <ktu/memory.hpp>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "check.hpp"
+
+using fmtflags = ktu::buf_io::fmtflags;
+
+/* What an ostream with the same flags and grouping outputs. */
+static std::string stream(const ktu::buffer &buf, long flags, unsigned long grouping = 0) {
+    std::ostringstream os;
+    os.iword(ktu::buf_io::manipFlagId) = flags;
+    os << ktu::buf_io::setgrouping(grouping) << buf;
+    return os.str();
+}
+
+static ktu::buffer bytes(const std::string &str) {
+    ktu::buffer buf;
+    buf.push_back((void*)str.data(), str.size());
+    return buf;
+}
+
+static std::string format(std::string_view spec, const ktu::buffer &buf) {
+    std::string result;
+    ktu::format_to(std::back_inserter(result), spec, buf);
+    return result;
+}
+
+static bool malformed(std::string_view spec) {
+    ktu::buffer buf;
+    try {
+        format(spec, buf);
+    } catch (const std::invalid_argument &) {
+        return true;
+    }
+    return false;
+}
+
+int main() {
+    ktu::buffer buf = bytes("Hi [\x01\xC3\xA9\x1B\x02 ok");
+
+    // An empty spec, or one with only padding, writes the raw bytes.
+    CHECK(format("", buf) == std::string("Hi [\x01\xC3\xA9\x1B\x02 ok"));
+    CHECK(format("*>16", buf) == std::string("****Hi [\x01\xC3\xA9\x1B\x02 ok"));
+
+    // Every field maps to the flag of the same name.
+    CHECK(format("x", buf) == stream(buf, fmtflags::fmt | fmtflags::hex));
+    CHECK(format("n", buf) == stream(buf, fmtflags::fmt));
+    CHECK(format("d", buf) == stream(buf, fmtflags::fmt | fmtflags::dec));
+    CHECK(format("o.3", buf) == stream(buf, fmtflags::fmt | fmtflags::oct, 3));
+    CHECK(format("ba", buf) == stream(buf, fmtflags::fmt | fmtflags::bin | fmtflags::ascii));
+    CHECK(format("l", buf) == stream(buf, fmtflags::fmt | fmtflags::latin_1));
+    CHECK(format("xu8-#.2", buf) == stream(buf, fmtflags::fmt | fmtflags::utf_8 | fmtflags::nozfill | fmtflags::fmtinfo, 2));
+    CHECK(format("u16le", buf) == stream(buf, fmtflags::fmt | fmtflags::utf_16le));
+    CHECK(format("u16be", buf) == stream(buf, fmtflags::fmt | fmtflags::utf_16be));
+    CHECK(format("u32le", buf) == stream(buf, fmtflags::fmt | fmtflags::utf_32le));
+    CHECK(format("u32be-", buf) == stream(buf, fmtflags::fmt | fmtflags::utf_32be | fmtflags::nozfill));
+    CHECK(format("#", buf) == "[[numeric hex]]" + stream(buf, fmtflags::fmt));
+    CHECK(format("u8", buf) == "Hi \\[[01]\xC3\xA9[1B02] ok");
+    CHECK(format(".4", buf) == "4869205B 01C3A91B 02206F6B");
+
+    // Width pads the rendered text, never truncates it.
+    CHECK(format("12a", buf).size() == stream(buf, fmtflags::fmt | fmtflags::ascii).size());
+    ktu::buffer small = bytes("\x0A\xFF");
+    CHECK(format("6x", small) == "0AFF  ");
+    CHECK(format(">6x", small) == "  0AFF");
+    CHECK(format("-^9x", small) == "--0AFF---");
+    CHECK(format("0>7d.1", small) == "010 255");
+    CHECK(format("<4", small) == "\x0A\xFF  ");
+    CHECK(format("9x", ktu::buffer()) == std::string(9, ' '));
+
+    // Views and readers of the same bytes format the same.
+    ktu::view v(buf.data(), buf.size());
+    ktu::reader r(buf.data(), buf.size());
+    std::string a, b;
+    ktu::format_to(std::back_inserter(a), "xu8.2", v);
+    ktu::format_to(std::back_inserter(b), "xu8.2", r);
+    CHECK(a == format("xu8.2", buf) && b == a);
+
+    // Output iterators other than back inserters.
+    char text[8] = {};
+    CHECK(ktu::format_to(text, "x", small.data(), small.size()) == text + 4 && std::string(text) == "0AFF");
+
+    // Parsing stops at the closing brace of a replacement field.
+    ktu::buffer_format spec;
+    std::string_view field = "xa.2}tail";
+    CHECK(spec.parse(field.begin(), field.end()) == field.begin() + 4);
+    CHECK(spec.flags == (fmtflags::fmt | fmtflags::hex | fmtflags::ascii) && spec.grouping == 2);
+
+    CHECK(malformed("z"));
+    CHECK(malformed("x."));
+    CHECK(malformed("xx"));
+    CHECK(malformed("u9"));
+    CHECK(malformed("#-"));
+    CHECK(!malformed("x-#"));
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include <ktu/front_coded_multi_string.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "check.hpp"
+
+static void check(const std::vector<std::string> &model, size_t bucket_size) {
+    ktu::front_coded_multi_string strings(model.begin(), model.end(), bucket_size);
+    CHECK(strings.size() == model.size() && strings.empty() == model.empty());
+    CHECK(strings.bucket_size() == bucket_size);
+    CHECK(strings.bucket_count() == (model.size() + bucket_size - 1) / bucket_size);
+    size_t i = 0;
+    for (auto it = strings.begin(); it != strings.end(); ++it, ++i)
+        CHECK(*it == model[i] && it.index() == i);
+    CHECK(i == model.size());
+    // Every string, and the values right before and after it in order, which are mostly not in it.
+    for (size_t pos = 0; pos < model.size(); ++pos) {
+        CHECK(strings[pos] == model[pos] && strings.at(pos) == model[pos]);
+        std::string values[] = {model[pos], model[pos] + '\0', model[pos] + "\xFF", model[pos].substr(0, model[pos].size() / 2)};
+        for (const std::string &value : values) {
+            size_t lower = std::lower_bound(model.begin(), model.end(), value) - model.begin();
+            CHECK(strings.lower_bound(value) == lower);
+            bool found = lower < model.size() && model[lower] == value;
+            CHECK(strings.find(value) == (found ? lower : ktu::front_coded_multi_string::npos));
+            CHECK(strings.contains(value) == found);
+        }
+    }
+    if (!model.empty()) {
+        CHECK(strings.front() == model.front() && strings.back() == model.back());
+        CHECK(strings.lower_bound("") == 0 && strings.lower_bound(model.back() + "\xFF") == model.size());
+    }
+}
+
+int main() {
+    // Shared prefixes and suffixes on both sides of the one and two byte varint limits, with duplicates and empty strings.
+    // The bucket sizes split each of them from the string before it somewhere.
+    std::vector<std::string> model = {"", ""};
+    for (size_t length : {1, 127, 128, 129, 16383, 16384}) {
+        std::string prefix(length, 'p');
+        model.push_back(prefix);
+        model.push_back(prefix);
+        model.push_back(prefix + "a");
+        model.push_back(prefix + std::string(length, 'b'));
+        model.push_back(prefix + "c");
+    }
+    std::sort(model.begin(), model.end());
+    for (size_t count : {0, 1, 2, 3, 16, 17}) {
+        std::vector<std::string> head(model.begin(), model.begin() + count);
+        check(head, 16);
+    }
+    for (size_t bucket_size : {1, 2, 3, 16, 100})
+        check(model, bucket_size);
+    {
+        ktu::multi_string sorted;
+        for (const char *s : {"", "apple", "applesauce", "apply", "banana"})
+            sorted.push_back(s);
+        ktu::front_coded_multi_string strings(sorted, 2);
+        CHECK(strings.size() == 5 && strings[2] == "applesauce" && strings[4] == "banana");
+        CHECK(strings.encoded_size() < sorted.cumulative_size() + strings.size());
+        ktu::front_coded_multi_string other = {"x"};
+        strings.swap(other);
+        CHECK(strings.size() == 1 && other.size() == 5);
+    }
+    bool unsorted = false, zero = false, range = false;
+    try {
+        ktu::front_coded_multi_string strings = {"b", "a"};
+    } catch (const std::invalid_argument &) {
+        unsorted = true;
+    }
+    try {
+        std::vector<std::string> model = {"a"};
+        ktu::front_coded_multi_string strings(model.begin(), model.end(), 0);
+    } catch (const std::invalid_argument &) {
+        zero = true;
+    }
+    try {
+        ktu::front_coded_multi_string strings = {"a"};
+        strings.at(1);
+    } catch (const std::out_of_range &) {
+        range = true;
+    }
+    CHECK(unsorted && zero && range);
+    return 0;
+}
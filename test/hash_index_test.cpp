@@ -0,0 +1,120 @@
+#include <ktu/multi_string.hpp>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "check.hpp"
+
+/* Checks lookup against the first equal string of the model, for every string in it and one that is not. */
+template <class MultiString>
+static void lookups(const MultiString &strings, const std::vector<std::string> &model) {
+    std::unordered_map<std::string, size_t> first;
+    for (size_t i = model.size(); i--;)
+        first[model[i]] = i;
+    for (const std::string &value : model)
+        CHECK(strings.lookup(value) - strings.begin() == first[value]);
+    CHECK(strings.lookup("missing") == strings.end());
+}
+
+template <class MultiString>
+static void maintained() {
+    MultiString strings;
+    strings.hash_index(true);
+    CHECK(strings.hash_index() && strings.hash_index_valid());
+    CHECK(strings.lookup("") == strings.end());
+    std::vector<std::string> model;
+    auto push = [&](const std::string &s) {
+        strings.push_back(s);
+        model.push_back(s);
+    };
+    // Duplicates find their first position.
+    for (const char *s : {"b", "a", "b", "", "a", ""})
+        push(s);
+    CHECK(strings.hash_index_valid());
+    lookups(strings, model);
+    // Erasing the first of equal strings moves the lookup to the next one, and positions after it shift down.
+    strings.erase(strings.begin());
+    model.erase(model.begin());
+    CHECK(strings.hash_index_valid());
+    lookups(strings, model);
+    strings.erase(strings.begin() + 1, strings.begin() + 3);
+    model.erase(model.begin() + 1, model.begin() + 3);
+    CHECK(strings.hash_index_valid());
+    lookups(strings, model);
+    strings.pop_back();
+    model.pop_back();
+    CHECK(strings.hash_index_valid() && strings.lookup("") == strings.end());
+    lookups(strings, model);
+    // Growing with resize adds empty strings, shrinking drops them again.
+    strings.resize(6);
+    model.resize(6);
+    CHECK(strings.hash_index_valid());
+    lookups(strings, model);
+    strings.resize(2);
+    strings.building_resize(0);
+    model.resize(2);
+    CHECK(strings.hash_index_valid());
+    lookups(strings, model);
+
+    // Enough strings to grow the table several times, then churn that leaves deleted slots behind.
+    for (size_t i = 0; i < 5000; ++i)
+        push(std::to_string(i));
+    CHECK(strings.hash_index_valid());
+    lookups(strings, model);
+    for (size_t i = 0; i < 5000; ++i) {
+        strings.pop_back();
+        model.pop_back();
+        push("churn" + std::to_string(i % 7));
+    }
+    CHECK(strings.hash_index_valid());
+    lookups(strings, model);
+
+    strings.push_back("last");
+    model.push_back("last");
+    strings.sort();
+    std::sort(model.begin(), model.end());
+    CHECK(strings.hash_index_valid());
+    lookups(strings, model);
+
+    // Edits invalidate it, lookups then scan and stay correct.
+    strings.substring_append(strings.begin() + 3, "x");
+    model[3] += "x";
+    CHECK(!strings.hash_index_valid());
+    lookups(strings, model);
+    strings.insert(strings.begin(), "inserted");
+    model.insert(model.begin(), "inserted");
+    CHECK(!strings.hash_index_valid() && strings.lookup("inserted") == strings.begin());
+    strings.rebuild_hash_index();
+    CHECK(strings.hash_index_valid());
+    lookups(strings, model);
+    strings.clear();
+    model.clear();
+    CHECK(strings.hash_index_valid() && strings.lookup("inserted") == strings.end());
+    strings.hash_index(false);
+    CHECK(!strings.hash_index() && !strings.hash_index_valid());
+    strings.push_back("a");
+    CHECK(strings.lookup("a") == strings.begin());
+}
+
+int main() {
+    maintained<ktu::multi_string>();
+    maintained<ktu::multi_string32>();
+    maintained<ktu::packed_multi_string>();
+    {
+        // Arena mode edits leave the index invalid the same way.
+        ktu::multi_string strings;
+        strings.arena_mode(true);
+        strings.hash_index(true);
+        for (const char *s : {"a", "b", "a", ""})
+            strings.push_back(s);
+        CHECK(strings.lookup("a") == strings.begin() && strings.lookup("") - strings.begin() == 3);
+        strings.substring_clear(strings.begin());
+        CHECK(!strings.hash_index_valid());
+        CHECK(strings.lookup("a") - strings.begin() == 2 && strings.lookup("") == strings.begin());
+        strings.rebuild_hash_index();
+        CHECK(strings.lookup("a") - strings.begin() == 2 && strings.lookup("") == strings.begin());
+        strings.compact();
+        CHECK(strings.lookup("b") - strings.begin() == 1);
+    }
+    return 0;
+}
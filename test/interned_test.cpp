@@ -0,0 +1,96 @@
+#include <ktu/interned_multi_string.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "check.hpp"
+
+int main() {
+    {
+        ktu::interned_multi_string strings = {"b", "a", "b", "", "a", ""};
+        CHECK(strings.size() == 6 && strings.unique_size() == 3);
+        CHECK(strings.id(0) == strings.id(2) && strings.id(1) == strings.id(4) && strings.id(3) == strings.id(5));
+        CHECK(strings[3] == "" && strings.back() == "" && strings.front() == "b");
+        CHECK(strings.lookup("a") == strings.id(1));
+        CHECK(strings.lookup("c") == ktu::interned_multi_string::npos);
+        CHECK(strings.string(strings.intern("c")) == "c" && strings.size() == 6 && strings.unique_size() == 4);
+        strings.erase(strings.begin());
+        strings.insert(strings.begin() + 1, "c");
+        CHECK(strings[0] == "a" && strings[1] == "c" && strings[2] == "b");
+        strings.clear();
+        CHECK(strings.empty() && strings.unique_size() == 4 && strings.lookup("b") != ktu::interned_multi_string::npos);
+        bool thrown = false;
+        try {
+            strings.at(0);
+        } catch (const std::out_of_range &) {
+            thrown = true;
+        }
+        CHECK(thrown);
+    }
+    {
+        // Every lookup still finds its id right after each growth of the table, at 13, 25, 49... unique strings.
+        ktu::interned_multi_string strings;
+        for (size_t i = 0; i < 400; ++i) {
+            CHECK(strings.push_back(std::to_string(i)) == i);
+            for (size_t j = 0; j <= i; ++j)
+                CHECK(strings.lookup(std::to_string(j)) == j);
+            CHECK(strings.lookup(std::to_string(i + 1)) == ktu::interned_multi_string::npos);
+        }
+        // Repeats take the id of the first entry and add no unique string.
+        for (size_t i = 400; i--;)
+            CHECK(strings.push_back(std::to_string(i)) == i);
+        CHECK(strings.size() == 800 && strings.unique_size() == 400);
+        size_t i = 0;
+        for (auto it = strings.begin(); it != strings.end(); ++it, ++i)
+            CHECK(it.id() == strings.id(i) && *it == strings.unique()[it.id()]);
+    }
+    {
+        // Strings hashed to the last slot of the first table wrap around to its first slots.
+        auto slot = [](const std::string &s) {
+            return (ktu::hash((const void*)s.data(), s.size()) * 0x9E3779B97F4A7C15ULL) >> 60;
+        };
+        std::vector<std::string> last;
+        std::string missing;
+        for (size_t i = 0; last.size() < 4 || missing.empty(); ++i) {
+            std::string s = "s" + std::to_string(i);
+            if (slot(s) != 15)
+                continue;
+            if (last.size() < 4)
+                last.push_back(s);
+            else
+                missing = s;
+        }
+        ktu::interned_multi_string strings;
+        for (const std::string &s : last)
+            strings.push_back(s);
+        for (size_t i = 0; i < last.size(); ++i)
+            CHECK(strings.lookup(last[i]) == i);
+        CHECK(strings.lookup(missing) == ktu::interned_multi_string::npos);
+    }
+    {
+        // Embedded zeros, prefixes and the empty string are distinct strings, wider characters hash all their bytes.
+        ktu::interned_multi_string strings;
+        const std::string zeros[] = {"", std::string(1, '\0'), std::string(2, '\0'), "a", std::string("a\0", 2), "ab"};
+        for (const std::string &s : zeros)
+            strings.push_back(s);
+        CHECK(strings.unique_size() == std::size(zeros));
+        for (size_t i = 0; i < std::size(zeros); ++i)
+            CHECK(strings.lookup(zeros[i]) == i && strings[i] == zeros[i]);
+        ktu::u16interned_multi_string wide = {u"\x0100", u"\x0001", u"\x0100"};
+        CHECK(wide.unique_size() == 2 && wide.id(0) == wide.id(2) && wide[1] == u"\x0001");
+    }
+    {
+        // The largest id is npos, so an 8 bit id holds 255 unique strings.
+        ktu::basic_interned_multi_string<char, uint8_t> strings;
+        for (int i = 0; i < 255; ++i)
+            strings.push_back(std::to_string(i));
+        bool thrown = false;
+        try {
+            strings.push_back("255");
+        } catch (const std::length_error &) {
+            thrown = true;
+        }
+        CHECK(thrown && strings.size() == 255);
+        CHECK(strings.push_back("7") == 7);
+    }
+    return 0;
+}
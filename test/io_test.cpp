@@ -0,0 +1,98 @@
+#include <ktu/ios.hpp>
+#include <charconv>
+#include <climits>
+#include <sstream>
+#include <string>
+#include "check.hpp"
+
+/* Renders into a buffer of exactly the given size. */
+template <class Render>
+static std::string render(Render render, size_t size, std::errc ec = std::errc()) {
+    char text[72];
+    std::to_chars_result result = render(text, text + size);
+    CHECK(result.ec == ec);
+    if (ec != std::errc()) {
+        CHECK(result.ptr == text + size);
+        return "";
+    }
+    return std::string(text, result.ptr);
+}
+
+/* Checks a value against std::to_chars in every base, with a buffer that fits and one that is one short. */
+static void compare(unsigned long value) {
+    const int bases[] = {2, 8, 10, 16};
+    for (int base : bases) {
+        char text[72];
+        std::string expected(text, std::to_chars(text, text + sizeof(text), value, base).ptr);
+        auto io = [&](char *first, char *last) {
+            switch (base) {
+                case 2: return ktu::io::bits(first, last, value);
+                case 8: return ktu::io::octal(first, last, value);
+                case 10: return ktu::io::decimal(first, last, value);
+                default: return ktu::io::hexadecimal(first, last, value);
+            }
+        };
+        CHECK(render(io, expected.size()) == expected);
+        render(io, expected.size() - 1, std::errc::value_too_large);
+    }
+}
+
+int main() {
+    compare(0);
+    compare(1);
+    compare(7);
+    compare(8);
+    compare(99);
+    compare(100);
+    compare(255);
+    compare(256);
+    compare(ULONG_MAX);
+    for (unsigned long value = 1; value; value <<= 1) {
+        compare(value);
+        compare(value - 1);
+        compare(value + 1);
+    }
+    for (unsigned long value = 1; value <= ULONG_MAX / 10; value *= 10) {
+        compare(value - 1);
+        compare(value);
+    }
+    CHECK(render([](char *first, char *last) {return ktu::io::hexadecimal(first, last, 0xABCDEFul, true);}, 6) == "ABCDEF");
+    render([](char *first, char *last) {return ktu::io::decimal(first, last, 0);}, 0, std::errc::value_too_large);
+
+    // Narrower and signed types are zero extended from their own width.
+    CHECK(render([](char *first, char *last) {return ktu::io::bits(first, last, 5u);}, 3) == "101");
+    CHECK(render([](char *first, char *last) {return ktu::io::bits(first, last, (signed char)-1);}, 8) == "11111111");
+    CHECK(render([](char *first, char *last) {return ktu::io::bits(first, last, (short)-2);}, 16) == "1111111111111110");
+    CHECK(render([](char *first, char *last) {return ktu::io::bits(first, last, -1);}, 32) == std::string(32, '1'));
+    CHECK(render([](char *first, char *last) {return ktu::io::bits(first, last, -1l);}, 64) == std::string(64, '1'));
+    CHECK(render([](char *first, char *last) {return ktu::io::bits(first, last, 0u);}, 1) == "0");
+    render([](char *first, char *last) {return ktu::io::bits(first, last, 5u);}, 2, std::errc::value_too_large);
+    // Floating point values render their representation.
+    CHECK(render([](char *first, char *last) {return ktu::io::bits(first, last, 1.0f);}, 30) == "111111100000000000000000000000");
+    CHECK(render([](char *first, char *last) {return ktu::io::bits(first, last, -0.0);}, 64) == "1" + std::string(63, '0'));
+
+    {
+        std::ostringstream os;
+        ktu::io::bits(os, 5u);
+        os << ' ';
+        ktu::io::bits(os, (unsigned char)0x80);
+        os << ' ';
+        ktu::io::bits(os, 2.0f);
+        os << ' ' << std::setw(6) << std::setfill('.');
+        ktu::io::bits(os, (short)3);
+        CHECK(os.str() == "101 10000000 1000000000000000000000000000000 ....11");
+    }
+    {
+        std::ostringstream os;
+        os << std::showbase << std::uppercase << std::internal << std::setfill('0') << std::setw(8);
+        ktu::io::hexadecimal(os, 0xAB);
+        os << ' ' << std::setw(5);
+        ktu::io::octal(os, 8);
+        os << ' ' << std::left << std::setw(4);
+        ktu::io::decimal(os, 0);
+        os << '|';
+        ktu::io::hexadecimal(os, 0);
+        CHECK(os.str() == "0X0000AB 00010 0000|0");
+    }
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include <ktu/json.hpp>
+#include <string>
+#include <vector>
+#include "check.hpp"
+
+using ktu::json::token_type;
+
+struct expected {
+    token_type type;
+    std::string value;
+};
+
+static ktu::view view(const std::string &input) {
+    return ktu::view(input.data(), input.size());
+}
+
+static void compare(const std::string &input, const std::vector<expected> &tokens) {
+    ktu::json::scanner scanner(view(input));
+    for (const expected &e : tokens) {
+        CHECK(scanner.next());
+        CHECK(scanner.get().type == e.type);
+        CHECK(ktu::json::unescape(scanner.get()) == e.value);
+    }
+    CHECK(!scanner.next());
+    CHECK(!scanner.failed());
+}
+
+static bool fails(const std::string &input) {
+    ktu::json::scanner scanner(view(input));
+    while (scanner.next());
+    return scanner.failed();
+}
+
+int main() {
+    compare("{\"a\": [1, -2.5e3, true, false, null], \"b\": {}, \"c\": []}", {
+        {token_type::object_begin, "{"},
+        {token_type::key, "a"},
+        {token_type::array_begin, "["},
+        {token_type::number, "1"},
+        {token_type::number, "-2.5e3"},
+        {token_type::boolean, "true"},
+        {token_type::boolean, "false"},
+        {token_type::null, "null"},
+        {token_type::array_end, "]"},
+        {token_type::key, "b"},
+        {token_type::object_begin, "{"},
+        {token_type::object_end, "}"},
+        {token_type::key, "c"},
+        {token_type::array_begin, "["},
+        {token_type::array_end, "]"},
+        {token_type::object_end, "}"},
+    });
+    compare("\"q\\\" \\\\ \\/ \\b\\f\\n\\r\\t \\u00e9 \\ud83d\\ude00\"", {
+        {token_type::string, "q\" \\ / \b\f\n\r\t \xC3\xA9 \xF0\x9F\x98\x80"},
+    });
+    compare("1\n\"two\"\n[3]\n", {
+        {token_type::number, "1"},
+        {token_type::string, "two"},
+        {token_type::array_begin, "["},
+        {token_type::number, "3"},
+        {token_type::array_end, "]"},
+    });
+    // Escapes, quotes and whitespace runs on both sides of the 64 byte blocks.
+    for (size_t pad = 50; pad < 140; ++pad) {
+        std::string text(pad, 'x');
+        compare("[\"" + text + "\\\"\\\\\"," + std::string(pad, ' ') + "\"" + text + "\"]", {
+            {token_type::array_begin, "["},
+            {token_type::string, text + "\"\\"},
+            {token_type::string, text},
+            {token_type::array_end, "]"},
+        });
+        CHECK(fails("[\"" + text + "\\\""));
+        CHECK(fails("\"" + text + "\n\""));
+    }
+    {
+        ktu::json::scanner scanner(view("{\"a\\n\": \"b\"}"));
+        CHECK(scanner.next() && scanner.next());
+        CHECK(scanner.get().escaped && ktu::json::unescape(scanner.get()) == "a\n");
+        CHECK(scanner.next() && !scanner.get().escaped);
+    }
+    CHECK(ktu::json::unescape(ktu::view("\\x", 2)).empty());
+    CHECK(ktu::json::unescape(ktu::view("\\udc00", 6)).empty());
+    CHECK(fails("{\"a\" 1}"));
+    CHECK(fails("[1,]"));
+    CHECK(fails("[1}"));
+    CHECK(fails("01"));
+    CHECK(fails("tru"));
+    CHECK(fails("[" + std::string(1, '"')));
+    CHECK(fails(std::string(ktu::json::scanner::max_depth + 1, '[')));
+    CHECK(!fails(std::string(ktu::json::scanner::max_depth, '[') + std::string(ktu::json::scanner::max_depth, ']')));
+    return 0;
+}
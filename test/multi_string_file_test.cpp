@@ -0,0 +1,96 @@
+#include <ktu/multi_string.hpp>
+#include <ktu/multi_string_view.hpp>
+#include <ktu/memory/file.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "check.hpp"
+
+static const std::filesystem::path path = std::filesystem::temp_directory_path() / "ktutils_multi_string_file_test.bin";
+
+template <class CharT>
+static void equal(const ktu::basic_multi_string_view<CharT> &view, const std::vector<std::basic_string<CharT>> &model) {
+    CHECK(view.is_open() && view.size() == model.size() && view.empty() == model.empty());
+    std::basic_string<CharT> cumulative;
+    for (size_t i = 0; i < model.size(); ++i) {
+        CHECK(view[i] == model[i] && view.at(i) == model[i]);
+        cumulative += model[i];
+    }
+    CHECK(view.cumulative_view() == cumulative);
+    size_t i = 0;
+    for (auto it = view.begin(); it != view.end(); ++it)
+        CHECK(*it == model[i++]);
+    CHECK(view.end() - view.begin() == model.size());
+}
+
+/* Writes substrings edited out of node order in arena mode, with the building substring left out of the file. */
+template <class MultiString>
+static void roundTrip(bool arena) {
+    using char_type = typename MultiString::char_type;
+    using string_type = std::basic_string<char_type>;
+    auto text = [](const char *s, size_t size) {
+        return string_type(s, s + size);
+    };
+    MultiString strings;
+    if constexpr (requires {strings.arena_mode(true);})
+        strings.arena_mode(arena);
+    std::vector<string_type> model = {text("", 0), text("a", 1), text("z\0z", 3), text("", 0), text("0123456789", 10), text("b", 1)};
+    for (const string_type &s : model)
+        strings.push_back(s);
+    // In arena mode each edit moves the substring behind the others and leaves its old copy as garbage.
+    strings.substring_insert(strings.begin() + 1, 0, text("pre", 3));
+    model[1].insert(0, text("pre", 3));
+    strings.substring_erase(strings.begin() + 4, 2, 5);
+    model[4].erase(2, 5);
+    strings.substring_append(strings.begin(), text("first", 5));
+    model[0] += text("first", 5);
+    strings.substring_clear(strings.begin() + 5);
+    model[5].clear();
+    strings.building_push_back(char_type('x'));
+    CHECK(strings.write(path));
+    ktu::basic_multi_string_view<char_type> view(path);
+    equal(view, model);
+}
+
+int main() {
+    roundTrip<ktu::multi_string>(false);
+    roundTrip<ktu::multi_string>(true);
+    roundTrip<ktu::multi_string32>(true);
+    roundTrip<ktu::packed_multi_string>(false);
+    roundTrip<ktu::u16multi_string>(false);
+    roundTrip<ktu::u32multi_string>(true);
+    {
+        ktu::multi_string strings;
+        CHECK(strings.write(path));
+        ktu::multi_string_view view;
+        CHECK(view.open(path));
+        equal(view, {});
+        for (const char *s : {"abc", "", "de"})
+            strings.push_back(s);
+        CHECK(strings.write(path));
+        // The header is checked against the character type and the size of the file.
+        ktu::u16multi_string_view wide;
+        CHECK(!wide.open(path) && !wide.is_open());
+        CHECK(view.open(path));
+        equal(view, {"abc", "", "de"});
+        // A smaller file written over a larger one is truncated.
+        ktu::multi_string one = {"x"};
+        CHECK(one.write(path));
+        CHECK(view.open(path));
+        equal(view, {"x"});
+        view.close();
+        CHECK(!view.is_open() && view.empty());
+        std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+        CHECK(!view.open(path));
+        {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file << "not a multi_string file at all, just long enough";
+        }
+        CHECK(!view.open(path));
+    }
+    std::filesystem::remove(path);
+    ktu::multi_string_view view;
+    CHECK(!view.open(path));
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include <ktu/multi_string.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "check.hpp"
+
+static_assert(sizeof(ktu::multi_string::node_type) == 2 * sizeof(size_t));
+static_assert(sizeof(ktu::multi_string32::node_type) == 8);
+static_assert(sizeof(ktu::packed_multi_string::node_type) == sizeof(size_t));
+static_assert(sizeof(ktu::packed_multi_string32::node_type) == 4);
+
+template <class MultiString>
+static void equal(const MultiString &strings, const std::vector<std::string> &model, const std::string &building) {
+    CHECK(strings.size() == model.size());
+    std::string cumulative;
+    for (size_t i = 0; i < model.size(); ++i) {
+        CHECK(strings[i] == model[i] && strings.at(i).size() == model[i].size());
+        cumulative += model[i];
+    }
+    size_t i = 0;
+    for (std::string_view s : strings)
+        CHECK(s == model[i++]);
+    CHECK(strings.building_string_view() == building);
+    CHECK(std::string(strings.cumulative_c_str()) == cumulative + building);
+}
+
+/* Edits every layout the same way where the packed layout has to derive sizes: empty substrings next to each other
+    and at both ends, and the last substring, whose size ends at the building substring.
+*/
+template <class MultiString>
+static void edges() {
+    MultiString strings;
+    std::vector<std::string> model = {"", "a", "", "bc", ""};
+    for (const std::string &s : model)
+        strings.push_back(s);
+    equal(strings, model, "");
+    strings.building_push_back('z');
+    equal(strings, model, "z");
+
+    strings.substring_append(strings.end() - 1, "xy");
+    model.back() = "xy";
+    equal(strings, model, "z");
+    strings.substring_erase(strings.end() - 1, 0, 2);
+    model.back().clear();
+    equal(strings, model, "z");
+    strings.substring_erase(strings.begin() + 1, 0, 1);
+    model[1].clear();
+    equal(strings, model, "z");
+
+    strings.insert(strings.begin(), "");
+    model.insert(model.begin(), "");
+    strings.insert(strings.end(), "end");
+    model.push_back("end");
+    strings.insert(strings.begin() + 2, "");
+    model.insert(model.begin() + 2, "");
+    equal(strings, model, "z");
+    strings.erase(strings.begin() + 1);
+    model.erase(model.begin() + 1);
+    equal(strings, model, "z");
+    strings.substring_insert(strings.begin(), 0, "front");
+    model[0] = "front";
+    equal(strings, model, "z");
+
+    strings.pop_back();
+    model.pop_back();
+    equal(strings, model, "");
+    strings.building_push_back('w');
+    strings.pop_back();
+    model.pop_back();
+    equal(strings, model, "");
+    while (!model.empty()) {
+        strings.erase(strings.begin());
+        model.erase(model.begin());
+        equal(strings, model, "");
+    }
+    strings.push_back("");
+    equal(strings, {""}, "");
+}
+
+template <class MultiString>
+static bool throws(MultiString &strings, std::string_view s) {
+    try {
+        strings.push_back(s);
+    } catch (const std::out_of_range &) {
+        return true;
+    }
+    return false;
+}
+
+int main() {
+    edges<ktu::multi_string>();
+    edges<ktu::multi_string32>();
+    edges<ktu::packed_multi_string>();
+    edges<ktu::packed_multi_string32>();
+    {
+        // The index type bounds the cumulative string.
+        ktu::basic_multi_string<char, uint8_t> strings;
+        for (int i = 0; i < 25; ++i)
+            CHECK(!throws(strings, "0123456789"));
+        CHECK(!throws(strings, "01234"));
+        CHECK(throws(strings, "0123456789"));
+        ktu::basic_multi_string<char, uint8_t, true> packed;
+        CHECK(!throws(packed, std::string(255, 'a')));
+        CHECK(throws(packed, "a"));
+    }
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include <ktu/memory.hpp>
+#include <random>
+#include <sstream>
+#include <string>
+#include "check.hpp"
+
+using fmtflags = ktu::buf_io::fmtflags;
+constexpr size_t mib = 1024 * 1024;
+
+static std::string render(const std::string &input, long flags, unsigned long grouping, unsigned threads) {
+    std::ostringstream os;
+    os.iword(ktu::buf_io::manipFlagId) = flags;
+    os << ktu::buf_io::setgrouping(grouping) << ktu::buf_io::setthreads(threads) << ktu::buf_io::output(input.data(), input.size());
+    return os.str();
+}
+
+/* Overwrites the input with the token so it begins offset bytes before the position. */
+static void place(std::string &input, size_t position, const std::string &token, size_t offset) {
+    input.replace(position - offset, token.size(), token);
+}
+
+int main() {
+    // Mostly multibyte text with ascii words, so the renderer has to look for a cut past every nominal one.
+    std::mt19937 rng(33);
+    const char *words[] = {"\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80", "text ", "\\", "[", "\xFF", "\x01\x02"};
+    std::string input;
+    while (input.size() < 5 * mib + 100)
+        input += words[rng() % std::size(words)];
+
+    // Sequences and bracketed runs cut by the nominal boundaries.
+    place(input, 1 * mib, "\xE2\x82\xAC", 1);
+    place(input, 2 * mib, "\xF0\x9F\x98\x80", 2);
+    place(input, 3 * mib, "abcd\xFF\xFE\x01 xyz", 5);
+    place(input, 4 * mib, "abcd\xF0\x9F\x98\x80", 7);
+    // No four ascii bytes in the mebibyte after 3 MiB, so that piece takes the one after it.
+    for (size_t i = 3 * mib + 8; i + 2 < 4 * mib - 8; i += 2)
+        place(input, i, "\xC3\xA9", 0);
+
+    for (long flags : {long(fmtflags::fmt | fmtflags::utf_8), long(fmtflags::fmt | fmtflags::utf_8 | fmtflags::dec | fmtflags::nozfill | fmtflags::fmtinfo)}) {
+        for (unsigned long grouping : {0ul, 3ul}) {
+            std::string single = render(input, flags, grouping, 1);
+            for (unsigned threads : {3u, 8u})
+                CHECK(render(input, flags, grouping, threads) == single);
+        }
+    }
+
+    // Below the threshold the output is the same too.
+    std::string small = input.substr(0, mib - 1);
+    CHECK(render(small, fmtflags::fmt | fmtflags::utf_8, 0, 4) == render(small, fmtflags::fmt | fmtflags::utf_8, 0, 1));
+
+    // The other encodings with runs cut in the middle of their groups.
+    for (long encoding : {long(fmtflags::numeric), long(fmtflags::ascii), long(fmtflags::latin_1), long(fmtflags::utf_16le), long(fmtflags::utf_32be)}) {
+        long flags = fmtflags::fmt | encoding;
+        std::string single = render(input, flags, 5, 1);
+        CHECK(render(input, flags, 5, 4) == single);
+    }
+    return 0;
+}
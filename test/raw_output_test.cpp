@@ -0,0 +1,68 @@
+#include <ktu/memory.hpp>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include "check.hpp"
+
+/* Sizes around the threshold above which raw output bypasses the buffer of a stream backed by a C file. */
+static const size_t sizes[] = {0, 1, 100, 64 * 1024 - 1, 64 * 1024, 64 * 1024 + 1, 300 * 1024 + 3};
+
+static std::string bytes(size_t size, unsigned seed) {
+    std::string str(size, '\0');
+    for (size_t i = 0; i < size; ++i)
+        str[i] = (char)(i * 151 + seed + i / 509);
+    return str;
+}
+
+/* Small writes go through the buffers of the stream and of stdio, the raw writes have to stay in order with them. */
+static void write(std::ostream &os, std::string &expected) {
+    unsigned seed = 0;
+    for (size_t size : sizes) {
+        std::string str = bytes(size, seed++);
+        os << "size " << size << ':';
+        os << ktu::buf_io::output(str.data(), str.size());
+        os << '\n';
+        expected += "size " + std::to_string(size) + ':' + str + '\n';
+    }
+}
+
+static std::string read(const char *path) {
+    std::ifstream is(path, std::ios::binary);
+    std::ostringstream contents;
+    contents << is.rdbuf();
+    return contents.str();
+}
+
+int main() {
+    std::string expected;
+    std::ostringstream os;
+    write(os, expected);
+    CHECK(os.str() == expected);
+
+    const char *path = "raw_output_test.bin";
+    {
+        std::ofstream file(path, std::ios::binary);
+        std::string again;
+        write(file, again);
+    }
+    CHECK(read(path) == expected);
+
+    // std::cout writes through stdout while synchronized with stdio, point it at the file for the direct writes.
+    std::fflush(stdout);
+    int saved = ::dup(STDOUT_FILENO);
+    CHECK(saved >= 0 && std::freopen(path, "wb", stdout));
+    std::string again;
+    std::printf("stdio ");
+    write(std::cout, again);
+    std::cout << std::flush;
+    std::fflush(stdout);
+    CHECK(::dup2(saved, STDOUT_FILENO) >= 0);
+    ::close(saved);
+    CHECK(std::cout.good());
+    CHECK(read(path) == "stdio " + expected);
+    std::remove(path);
+    return 0;
+}
@@ -0,0 +1,278 @@
+#include <ktu/memory.hpp>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include "check.hpp"
+
+using buf_io = ktu::buf_io;
+using fmtflags = buf_io::fmtflags;
+
+/* The formatted branch of operator<< for buf_io::output before it rendered from digit tables.
+    It reads up to a few bytes past size, callers leave zeros there.
+*/
+static void reference(std::ostream &os, const void *ptr, size_t size) {
+    long flags = os.iword(buf_io::manipFlagId);
+    if (flags & fmtflags::fmtinfo) {
+        os << "[[";
+        switch (flags & fmtflags::encodingfield) {
+            case fmtflags::numeric: os << "numeric"; break;
+            case fmtflags::ascii: os << "ascii"; break;
+            case fmtflags::latin_1: os << "latin_1"; break;
+            case fmtflags::utf_8: os << "utf_8"; break;
+            case fmtflags::utf_16le: os << "utf_16le"; break;
+            case fmtflags::utf_16be: os << "utf_16be"; break;
+            case fmtflags::utf_32le: os << "utf_32le"; break;
+            case fmtflags::utf_32be: os << "utf_32be"; break;
+        }
+        os << ' ';
+        switch (flags & fmtflags::basefield) {
+            case fmtflags::bin: os << "bin"; break;
+            case fmtflags::oct: os << "oct"; break;
+            case fmtflags::dec: os << "dec"; break;
+            case fmtflags::hex: os << "hex"; break;
+        }
+        os << "]]";
+    }
+    std::ios tmpState(nullptr);
+    tmpState.copyfmt(os);
+
+    unsigned long grouping = os.iword(buf_io::manipGroupingId);
+    int width = 0;
+    std::ostream &(*formatted)(std::ostream&, unsigned long) = nullptr;
+    bool nozfill = (flags & fmtflags::nozfill);
+    switch (flags & fmtflags::basefield) {
+        case fmtflags::bin:
+            width = (nozfill) ? 0 : 8;
+            formatted = &ktu::io::bits;
+            break;
+        case fmtflags::oct:
+            width = (nozfill) ? 0 : 3;
+            formatted = &ktu::io::octal;
+            break;
+        case fmtflags::dec:
+            width = (nozfill) ? 0 : 3;
+            formatted = &ktu::io::decimal;
+            break;
+        case fmtflags::hex:
+            width = (nozfill) ? 0 : 2;
+            os << std::uppercase;
+            formatted = &ktu::io::hexadecimal;
+            break;
+    }
+    auto separator = [&](unsigned long &j) {
+        if (++j == grouping) {
+            os << ' ';
+            j = 0;
+        } else if (nozfill) {
+            os << ':';
+        }
+    };
+    auto number = [&](uint8_t value) {
+        os << std::setfill('0') << std::setw(width);
+        formatted(os, value);
+    };
+
+    const uint8_t *cur = (const uint8_t*)ptr, *end = cur + size;
+    switch (flags & fmtflags::encodingfield) {
+        case fmtflags::numeric: {
+            unsigned long j = 0;
+            number(*cur);
+            while (++cur != end) {
+                separator(j);
+                number(*cur);
+            }
+            break;
+        }
+        case fmtflags::ascii:
+        case fmtflags::latin_1: {
+            bool latin_1 = (flags & fmtflags::encodingfield) == fmtflags::latin_1;
+            auto printable = [latin_1](uint8_t value) {return (0x1F < value && value < 0x7F) || (latin_1 && value > 0xA0);};
+            uint8_t value = *cur;
+            while (cur != end) {
+                if (printable(value)) {
+                    do {
+                        char buf[4];
+                        if (value == '\\' || value == '[') os << '\\';
+                        os.write(buf, ktu::u8::write(value, buf));
+                        value = *(++cur);
+                    } while (cur != end && printable(value));
+                } else {
+                    unsigned long j = 0;
+                    os << '[';
+                    number(value);
+                    value = *(++cur);
+                    while (cur != end && !printable(value)) {
+                        separator(j);
+                        number(value);
+                        value = *(++cur);
+                    }
+                    os << ']';
+                }
+            }
+            break;
+        }
+        default: {
+            uint32_t (*read)(const void**) = nullptr;
+            switch (flags & fmtflags::encodingfield) {
+                case fmtflags::utf_8: read = ktu::u8::ptr::read_ref; break;
+                case fmtflags::utf_16le: read = ktu::u16::ptr::read_ref_le; break;
+                case fmtflags::utf_16be: read = ktu::u16::ptr::read_ref_be; break;
+                case fmtflags::utf_32le: read = ktu::u32::ptr::read_ref_le; break;
+                case fmtflags::utf_32be: read = ktu::u32::ptr::read_ref_be; break;
+            }
+            auto printable = [](uint32_t codepoint) {return ktu::validUnicode(codepoint) && 0x1F < codepoint;};
+            const uint8_t *tmp = cur;
+            uint32_t codepoint = read((const void**)&tmp);
+            while (cur < end) {
+                if (printable(codepoint)) {
+                    do {
+                        char buf[4];
+                        cur = tmp;
+                        if (codepoint == '\\' || codepoint == '[') os << '\\';
+                        os.write(buf, ktu::u8::write(codepoint, buf));
+                        codepoint = read((const void**)&tmp);
+                    } while (printable(codepoint) && cur < end);
+                } else {
+                    unsigned long j = 0;
+                    os << '[';
+                    while (true) {
+                        if (cur != tmp) {
+                            number(*cur++);
+                            while (cur != tmp && cur != end) {
+                                separator(j);
+                                number(*cur++);
+                            }
+                        }
+                        codepoint = read((const void**)&tmp);
+                        if ((printable(codepoint) && codepoint != '[') || cur >= end)
+                            break;
+                        separator(j);
+                    }
+                    os << ']';
+                }
+            }
+            break;
+        }
+    }
+    os.copyfmt(tmpState);
+}
+
+static std::string render(const std::string &input, long flags, unsigned long grouping, bool old) {
+    // Zeros past the end for the reads of the old code.
+    std::string padded = input + std::string(8, '\0');
+    std::ostringstream os;
+    os.iword(buf_io::manipFlagId) = flags;
+    os.iword(buf_io::manipGroupingId) = grouping;
+    if (old)
+        reference(os, padded.data(), input.size());
+    else
+        os << buf_io::output(padded.data(), input.size());
+    return os.str();
+}
+
+static std::string render(const std::string &input, long flags, unsigned long grouping = 0) {
+    return render(input, flags, grouping, false);
+}
+
+/* Random bytes drawn mostly from the printable and invalid ranges of the encoding, ending in four ascii code units.
+    The old code decodes past the end of a codepoint cut off by the end of the input, the ascii tail keeps
+        every codepoint within the input.
+*/
+static std::string sample(std::mt19937 &rng, size_t size, unsigned stride, bool big_endian) {
+    static const char chars[] = "az [\\\x7F\x80\xA0\xA1\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\xF7\xFF\xD8\xDC\x00\x01\x10\x1F";
+    static const std::string alphabet(chars, sizeof(chars) - 1);
+    std::string input(size - size % stride, ' ');
+    for (char &c : input)
+        c = (rng() % 4) ? alphabet[rng() % alphabet.size()] : (char)rng();
+    for (unsigned i = 0; i < 4; i++) {
+        std::string unit(stride, '\0');
+        unit[big_endian ? stride - 1 : 0] = 'z';
+        input += unit;
+    }
+    return input;
+}
+
+/* Ascii runs of every length up to a few blocks of the classifier, started at each alignment and ended by each kind of
+    character that leaves the bulk copy, must render as the per character renderer does.
+*/
+static void runs(long encoding, unsigned stride, bool big_endian) {
+    auto units = [&](const std::string &bytes) {
+        std::string encoded;
+        for (char c : bytes) {
+            std::string unit(stride, '\0');
+            unit[big_endian ? stride - 1 : 0] = c;
+            encoded += unit;
+        }
+        return encoded;
+    };
+    // Characters after the run: escaped, delete, control, latin-1 and the start of a utf-8 sequence.
+    const std::string enders[] = {"[", "\\", "\x7F", "\x1F", "\xE9", "\xC3\xA9", "\xE2\x82\xAC"};
+    for (size_t length = 0; length <= 140; ++length) {
+        std::string run(length, ' ');
+        for (size_t i = 0; i < length; ++i)
+            run[i] = 'A' + i % 26;
+        for (size_t align = 0; align < 3; ++align) {
+            for (const std::string &ender : enders) {
+                // Multibyte characters are a single unit of the wider encodings.
+                std::string tail = (stride == 1) ? ender : units(ender.substr(0, 1));
+                std::string input = units(std::string(align, '.')) + units(run) + tail + units("zzzz");
+                long flags = fmtflags::fmt | encoding;
+                CHECK(render(input, flags, 0) == render(input, flags, 0, true));
+            }
+        }
+    }
+}
+
+int main() {
+    const long encodings[] = {
+        fmtflags::numeric, fmtflags::ascii, fmtflags::latin_1, fmtflags::utf_8,
+        fmtflags::utf_16le, fmtflags::utf_16be, fmtflags::utf_32le, fmtflags::utf_32be
+    };
+    const long bases[] = {fmtflags::hex, fmtflags::dec, fmtflags::oct, fmtflags::bin};
+    std::mt19937 rng(31);
+    for (size_t round = 0; round < 400; ++round) {
+        long encoding = encodings[round % std::size(encodings)];
+        long flags = fmtflags::fmt | encoding | bases[rng() % 4] | ((rng() % 2) ? long(fmtflags::nozfill) : 0) | ((rng() % 4) ? 0 : long(fmtflags::fmtinfo));
+        unsigned long grouping = rng() % 5;
+        unsigned stride = (encoding == fmtflags::utf_16le || encoding == fmtflags::utf_16be) ? 2 :
+            (encoding == fmtflags::utf_32le || encoding == fmtflags::utf_32be) ? 4 : 1;
+        bool big_endian = encoding == fmtflags::utf_16be || encoding == fmtflags::utf_32be;
+        // Some inputs span several of the 64KiB blocks of the renderer.
+        std::string input = sample(rng, (round % 20) ? rng() % 300 : 70000 + rng() % 70000, stride, big_endian);
+        CHECK(render(input, flags, grouping) == render(input, flags, grouping, true));
+    }
+
+    runs(fmtflags::ascii, 1, false);
+    runs(fmtflags::latin_1, 1, false);
+    runs(fmtflags::utf_8, 1, false);
+    runs(fmtflags::utf_16le, 2, false);
+    runs(fmtflags::utf_32be, 4, true);
+
+    // A sequence cut off by the end of the input is written numerically and does not take the bytes before it.
+    CHECK(render("x\xF7" "BA", fmtflags::fmt | fmtflags::utf_8) == "x[F74241]");
+    CHECK(render("x\xE2\x82", fmtflags::fmt | fmtflags::utf_8) == "x[E282]");
+    CHECK(render("\xC3", fmtflags::fmt | fmtflags::utf_8) == "[C3]");
+    CHECK(render("ab\xC3\xA9\xF0\x9F", fmtflags::fmt | fmtflags::utf_8 | fmtflags::dec, 1) == "ab\xC3\xA9[240 159]");
+    CHECK(render(std::string("a\0\x3D\xD8", 4), fmtflags::fmt | fmtflags::utf_16le) == "a[3DD8]");
+    CHECK(render(std::string("a\0\0\0b\0", 6), fmtflags::fmt | fmtflags::utf_32le) == "a[6200]");
+    // The same bytes in the middle of the input.
+    CHECK(render("x\xF7" "BAC", fmtflags::fmt | fmtflags::utf_8) == "x[F7424143]");
+
+    // Both renderers on a buffer that is mostly invalid, timed.
+    std::string input(4 * 1024 * 1024, '\0');
+    for (char &c : input)
+        c = rng();
+    auto time = [&](bool old) {
+        auto start = std::chrono::steady_clock::now();
+        std::string text = render(input, fmtflags::fmt | fmtflags::hex, 0, old);
+        return std::make_pair(text, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    };
+    auto [current, currentTime] = time(false);
+    auto [old, oldTime] = time(true);
+    std::cout << "hex numeric 4MiB: " << oldTime << "s before, " << currentTime << "s now\n";
+    CHECK(current == old);
+    CHECK(currentTime < oldTime);
+    return 0;
+}
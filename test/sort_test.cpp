@@ -0,0 +1,104 @@
+#include <ktu/multi_string.hpp>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "check.hpp"
+
+/* Sorts the strings with each amount of threads and checks them against std::sort, then the bounds of every string and of
+    values next to them.
+*/
+template <class MultiString>
+static void sorted(const std::vector<typename MultiString::string_type> &input, bool arena = false) {
+    using string_type = typename MultiString::string_type;
+    std::vector<string_type> model = input;
+    std::sort(model.begin(), model.end());
+    for (unsigned threads : {1u, 4u}) {
+        MultiString strings;
+        if constexpr (requires {strings.arena_mode(true);})
+            strings.arena_mode(arena);
+        for (const string_type &s : input)
+            strings.push_back(s);
+        if (arena && !input.empty()) {
+            // Edits move substrings behind the building substring, so the cumulative string is out of node order.
+            for (size_t pos = 0; pos < input.size(); pos += 3) {
+                strings.substring_clear(strings.begin() + pos);
+                strings.substring_append(strings.begin() + pos, input[pos]);
+            }
+        }
+        strings.building_push_back('b');
+        strings.sort(threads);
+        CHECK(strings.size() == model.size());
+        for (size_t i = 0; i < model.size(); ++i)
+            CHECK(strings[i] == model[i]);
+        CHECK(strings.building_string_view().size() == 1 && strings.building_string_view()[0] == 'b');
+
+        std::vector<string_type> values = model;
+        for (const string_type &s : model) {
+            values.push_back(s + typename MultiString::char_type('a'));
+            if (!s.empty())
+                values.push_back(s.substr(0, s.size() - 1));
+        }
+        for (const string_type &value : values) {
+            size_t lower = std::lower_bound(model.begin(), model.end(), value) - model.begin();
+            size_t upper = std::upper_bound(model.begin(), model.end(), value) - model.begin();
+            CHECK(strings.lower_bound(value) - strings.begin() == lower);
+            CHECK(strings.upper_bound(value) - strings.begin() == upper);
+            auto [first, last] = strings.equal_range(value);
+            CHECK(first - strings.begin() == lower && last - strings.begin() == upper);
+        }
+    }
+}
+
+int main() {
+    {
+        ktu::multi_string strings;
+        strings.sort();
+        CHECK(strings.empty() && strings.lower_bound("a") == strings.end());
+        for (const char *s : {"pear", "", "apple", "pea", "apple", "\xFF", "Z"})
+            strings.push_back(s);
+        strings.sort();
+        std::vector<std::string> expected = {"", "Z", "apple", "apple", "pea", "pear", "\xFF"};
+        for (size_t i = 0; i < expected.size(); ++i)
+            CHECK(strings[i] == expected[i]);
+        CHECK(strings.lower_bound("apple") - strings.begin() == 2);
+        CHECK(strings.upper_bound("apple") - strings.begin() == 4);
+        CHECK(strings.lower_bound("peach") - strings.begin() == 5);
+        CHECK(strings.upper_bound("\xFF\xFF") == strings.end());
+        CHECK(strings.lower_bound("") == strings.begin() && strings.upper_bound("") - strings.begin() == 1);
+    }
+    sorted<ktu::multi_string>({});
+    sorted<ktu::multi_string>({"only"});
+    sorted<ktu::multi_string>({"", "", ""});
+
+    // Enough strings for the radix passes, with bytes above 0x7F that must order after ascii, embedded zeros and prefixes.
+    std::vector<std::string> bytes;
+    for (unsigned i = 0; i < 600; ++i) {
+        std::string s(1, (char)(i * 37 % 256));
+        if (i % 3)
+            s.push_back((char)(255 - i % 256));
+        if (i % 5 == 0)
+            s.push_back('\0');
+        bytes.push_back(s);
+        bytes.push_back(s.substr(0, 1));
+    }
+    sorted<ktu::multi_string>(bytes);
+    sorted<ktu::multi_string>(bytes, true);
+    sorted<ktu::multi_string32>(bytes, true);
+    sorted<ktu::packed_multi_string>(bytes);
+
+    // Prefixes shared past the radix depth fall back to comparisons, and so do short runs between distinct heads.
+    std::vector<std::string> deep;
+    for (unsigned i = 0; i < 200; ++i) {
+        deep.push_back(std::string(300, 'p') + std::to_string(i * 7919 % 200));
+        deep.push_back(std::string(i % 40, 'q') + "r");
+    }
+    sorted<ktu::multi_string>(deep);
+    sorted<ktu::packed_multi_string>(deep);
+
+    // Characters wider than a byte.
+    std::vector<std::u16string> wide;
+    for (char16_t i = 0; i < 300; ++i)
+        wide.push_back({char16_t(i * 331), char16_t(0x7F + i % 3)});
+    sorted<ktu::u16multi_string>(wide);
+    return 0;
+}
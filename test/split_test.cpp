@@ -0,0 +1,103 @@
+#include <ktu/multi_string.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "check.hpp"
+
+static const std::filesystem::path path = std::filesystem::temp_directory_path() / "ktutils_split_test.txt";
+
+static std::vector<std::string> reference(const std::string &text, char delimiter, bool lines) {
+    std::vector<std::string> fields;
+    size_t start = 0;
+    for (size_t end; (end = text.find(delimiter, start)) != std::string::npos; start = end + 1)
+        fields.push_back(text.substr(start, end - start));
+    if (start < text.size() || !lines)
+        fields.push_back(text.substr(start));
+    if (lines) {
+        for (std::string &field : fields) {
+            if (!field.empty() && field.back() == '\r')
+                field.pop_back();
+        }
+    }
+    return fields;
+}
+
+static void equal(const ktu::multi_string &strings, const std::vector<std::string> &model) {
+    CHECK(strings.size() == model.size());
+    for (size_t i = 0; i < model.size(); ++i)
+        CHECK(strings[i] == model[i]);
+}
+
+static void write(const std::string &text) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << text;
+}
+
+/* Loads the text after a substring already in the container and with a building substring, which must be kept. */
+static void load(const std::string &text, bool arena, unsigned threads) {
+    std::vector<std::string> model = reference(text, '\n', true);
+    model.insert(model.begin(), "first");
+    write(text);
+    ktu::multi_string strings;
+    strings.arena_mode(arena);
+    strings.push_back("first");
+    strings.building_push_back('b');
+    CHECK(strings.load_lines(path, threads));
+    equal(strings, model);
+    CHECK(strings.building_string_view() == "b");
+}
+
+int main() {
+    for (const char *text : {"", "\n", "\r\n", "a", "a\n", "a\r\n", "a\nb", "a\r\nb\r\n", "\n\n", "a\r\r\n\rb\n", "\r"}) {
+        for (bool arena : {false, true})
+            load(text, arena, 1);
+    }
+    {
+        ktu::multi_string strings;
+        strings.split("a,,b,", ',');
+        equal(strings, {"a", "", "b", ""});
+        strings.split("", ',');
+        equal(strings, {"a", "", "b", "", ""});
+        // Carriage returns are only dropped from lines.
+        strings.clear();
+        strings.split("a\r\nb", '\n');
+        equal(strings, {"a\r", "b"});
+    }
+    // Threads scan equal parts of the text, so delimiters and carriage returns go on both sides of every part boundary.
+    // The shortest text is one byte too short for threads and is split on the calling thread.
+    for (unsigned threads : {2u, 3u, 8u}) {
+        for (size_t length : {threads * 64 - 1, threads * 64, threads * 200 + 5}) {
+            size_t part = length / threads;
+            for (size_t shift : {0, 1, 2}) {
+                std::string text(length, 'a');
+                for (size_t boundary = part; boundary < length; boundary += part) {
+                    text[boundary - shift] = '\n';
+                    if (boundary - shift > 0)
+                        text[boundary - shift - 1] = '\r';
+                    if (boundary + 1 < length)
+                        text[boundary + 1] = '\n';
+                }
+                load(text, false, threads);
+                load(text, true, threads);
+                load(text + "\n", false, threads);
+            }
+        }
+        // Only delimiters, and none at all.
+        load(std::string(threads * 100, '\n'), false, threads);
+        load(std::string(threads * 100, 'x'), true, threads);
+        load(std::string(threads * 100, '\r') + "\n", false, threads);
+    }
+    {
+        std::string text = "a,b,,c,";
+        for (size_t i = 0; i < 6; ++i)
+            text += text;
+        ktu::multi_string strings;
+        strings.split(text, ',');
+        equal(strings, reference(text, ',', false));
+    }
+    std::filesystem::remove(path);
+    ktu::multi_string strings;
+    CHECK(!strings.load_lines(path));
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include <ktu/string.hpp>
+#include <ktu/memory/view.hpp>
+#include <charconv>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include "check.hpp"
+
+template <class T>
+static void compare(const std::string &input, int base) {
+    const char *first = input.data(), *last = first + input.size();
+    T expected = 7, value = 7;
+    std::from_chars_result a = std::from_chars(first, last, expected, base);
+    std::from_chars_result b = ktu::ston(first, last, value, base);
+    CHECK(a.ec == b.ec);
+    CHECK(value == expected);
+    // from_chars leaves ptr at first on invalid input, but past the digits when out of range.
+    CHECK(a.ptr == b.ptr);
+}
+
+template <class T>
+static void compareAll(const std::string &input) {
+    for (int base : {2, 8, 10, 16, 36})
+        compare<T>(input, base);
+}
+
+template <class T>
+static void random(std::mt19937_64 &rng) {
+    const std::string digits = "0123456789abcdefABCDEFxz-+ ";
+    for (size_t i = 0; i < 20000; ++i) {
+        std::string input;
+        size_t length = rng() % 40;
+        // Mostly digits, long enough to reach the word at a time paths and overflow.
+        for (size_t j = 0; j < length; ++j)
+            input.push_back((rng() % 8) ? digits[rng() % 16] : digits[rng() % digits.size()]);
+        if (rng() % 4 == 0)
+            input.insert(0, "-");
+        compareAll<T>(input);
+        T value = (T)rng();
+        for (int base : {2, 8, 10, 16}) {
+            char text[80];
+            std::to_chars_result end = std::to_chars(text, text + sizeof(text), value, base);
+            T parsed = 0;
+            std::from_chars_result result = ktu::ston(text, end.ptr, parsed, base);
+            CHECK(result.ec == std::errc() && result.ptr == end.ptr && parsed == value);
+        }
+    }
+}
+
+constexpr int parsed(const char *text) {
+    int value = 0;
+    ktu::ston(text, text + std::char_traits<char>::length(text), value);
+    return value;
+}
+static_assert(parsed("12345678901") == 0);
+static_assert(parsed("-0x7fffffff") == -0x7fffffff);
+static_assert(parsed("0b101") == 5);
+
+int main() {
+    for (const char *input : {
+        "", "-", "0", "-0", "00000000000000000000000000001", "18446744073709551615", "18446744073709551616",
+        "9223372036854775807", "9223372036854775808", "-9223372036854775808", "-9223372036854775809",
+        "ffffffffffffffff", "10000000000000000", "12345678x", "1234567890123456789012345", "+1", " 1"
+    }) {
+        compareAll<uint64_t>(input);
+        compareAll<int64_t>(input);
+        compareAll<uint32_t>(input);
+        compareAll<int8_t>(input);
+    }
+    {
+        // Base 0 reads the prefix.
+        int64_t value = 0;
+        std::string input = "0x1F 0b11 017 0 -0x10 0x 08";
+        const char *ptr = input.data(), *last = ptr + input.size();
+        int64_t expected[] = {0x1F, 3, 017, 0, -0x10, 0, 0};
+        const char *rest[] = {" 0b11", " 017", " 0", " -0x10", " 0x", "x 08", "8"};
+        for (size_t i = 0; i < std::size(expected); ++i) {
+            std::from_chars_result result = ktu::ston(ptr, last, value);
+            CHECK(result.ec == std::errc() && value == expected[i]);
+            CHECK(std::string(result.ptr, last).starts_with(rest[i]));
+            for (ptr = result.ptr; ptr != last && (*ptr == ' ' || *ptr == 'x'); ++ptr);
+        }
+    }
+    {
+        std::vector<int> values;
+        std::string input = "1,-2,30,0x40,";
+        auto result = ktu::parse_many<int>(ktu::view(input.data(), input.size()), ',', std::back_inserter(values));
+        CHECK(result.ec == std::errc() && result.ptr == input.data() + input.size());
+        CHECK((values == std::vector<int>{1, -2, 30, 0x40}));
+        values.clear();
+        input = "1,2;3";
+        result = ktu::parse_many<int>(input.data(), input.data() + input.size(), ',', std::back_inserter(values));
+        CHECK(result.ec == std::errc::invalid_argument && *result.ptr == ';' && values.size() == 2);
+        input = "1,99999999999";
+        result = ktu::parse_many<int>(input.data(), input.data() + input.size(), ',', std::back_inserter(values));
+        CHECK(result.ec == std::errc::result_out_of_range && values.size() == 3);
+    }
+    std::mt19937_64 rng(39);
+    random<uint64_t>(rng);
+    random<int64_t>(rng);
+    random<uint16_t>(rng);
+    random<int32_t>(rng);
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include <ktu/memory.hpp>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include "check.hpp"
+
+using fmtflags = ktu::buf_io::fmtflags;
+constexpr size_t block = ktu::buffer::block_size;
+
+/* Pads the text with spaces until the token straddles the next block boundary, offset of its bytes before it. */
+static void straddle(std::string &text, const std::string &token, size_t offset) {
+    size_t boundary = (text.size() / block + 1) * block;
+    if (text.size() + offset > boundary)
+        boundary += block;
+    text.append(boundary - offset - text.size(), ' ');
+    text += token;
+}
+
+static ktu::buffer bytes(const std::string &str) {
+    ktu::buffer buf;
+    buf.push_back((void*)str.data(), str.size());
+    return buf;
+}
+
+static ktu::buffer stream(const std::string &text, long flags) {
+    std::istringstream is(text);
+    is.iword(ktu::buf_io::manipFlagId) = flags;
+    ktu::buffer buf;
+    is >> buf;
+    CHECK(is.eof() && !is.fail());
+    return buf;
+}
+
+/* Writes the text into a pipe from another thread, a pipe holds less than a block. */
+template <class Read>
+static ktu::buffer pipe(const std::string &text, Read read) {
+    int fds[2];
+    CHECK(::pipe(fds) == 0);
+    std::thread writer([&]() {
+        for (size_t written = 0; written < text.size();) {
+            ssize_t count = ::write(fds[1], text.data() + written, text.size() - written);
+            CHECK(count > 0);
+            written += count;
+        }
+        ::close(fds[1]);
+    });
+    ktu::buffer buf;
+    CHECK(read(buf, fds[0]));
+    writer.join();
+    ::close(fds[0]);
+    return buf;
+}
+
+int main() {
+    // Every kind of token cut by a block boundary, the formatted reads must keep the state of the decoder across blocks.
+    std::string text;
+    straddle(text, "ab", 1);
+    straddle(text, "[[utf_8]]", 4);
+    straddle(text, "\xE2\x82\xAC", 1);
+    straddle(text, "\xE2\x82\xAC", 2);
+    straddle(text, "\\[", 1);
+    straddle(text, "[1 2 ff]", 3);
+    straddle(text, "[[hex]]", 1);
+    straddle(text, "c0ffee", 5);
+    CHECK(text.size() > 8 * block);
+
+    for (long encoding : {long(fmtflags::numeric), long(fmtflags::ascii), long(fmtflags::utf_8)}) {
+        long flags = fmtflags::fmt | encoding;
+        ktu::buffer whole;
+        whole.input(text, flags);
+        CHECK(stream(text, flags | fmtflags::endf) == whole);
+        CHECK(pipe(text, [flags](ktu::buffer &buf, int fd) {return buf.input(fd, flags);}) == whole);
+    }
+
+    // Raw reads of bytes that are no multiple of the block size.
+    std::string raw(3 * block + 17, '\0');
+    for (size_t i = 0; i < raw.size(); ++i)
+        raw[i] = (char)(i * 131 + i / 251);
+    CHECK(stream(raw, fmtflags::nofmt | fmtflags::endf) == bytes(raw));
+    CHECK(pipe(raw, [](ktu::buffer &buf, int fd) {return buf.pushf(fd);}) == bytes(raw));
+
+    // A line longer than a block stops at its newline, raw and formatted, and the next read takes the line after it.
+    std::string line(2 * block + 5, 'f');
+    for (long flags : {long(fmtflags::nofmt), long(fmtflags::fmt | fmtflags::hex)}) {
+        std::istringstream is(line + "\n12");
+        is.iword(ktu::buf_io::manipFlagId) = flags;
+        ktu::buffer first, second, expected;
+        is >> first;
+        CHECK(!is.eof());
+        is >> second;
+        CHECK(is.eof() && !is.fail());
+        if (flags & fmtflags::fmtfield) {
+            expected.input(line, flags);
+            CHECK(first == expected && second == bytes("\x12"));
+        } else {
+            CHECK(first == bytes(line) && second == bytes("12"));
+        }
+    }
+    return 0;
+}
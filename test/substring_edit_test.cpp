@@ -0,0 +1,106 @@
+#include <ktu/multi_string.hpp>
+#include <string>
+#include <vector>
+#include "check.hpp"
+
+template <class MultiString>
+static void equal(const MultiString &strings, const std::vector<std::string> &model, const std::string &building) {
+    CHECK(strings.size() == model.size());
+    std::string cumulative;
+    for (size_t i = 0; i < model.size(); ++i) {
+        CHECK(strings[i] == model[i]);
+        cumulative += model[i];
+    }
+    CHECK(strings.building_string_view() == building);
+    CHECK(std::string(strings.cumulative_c_str()) == cumulative + building);
+}
+
+template <class MultiString>
+static void edits() {
+    MultiString strings;
+    std::vector<std::string> model;
+    // Enough nodes that an edit near the front moves thousands of indices.
+    for (size_t i = 0; i < 3000; ++i) {
+        model.push_back(std::to_string(i));
+        strings.push_back(model.back());
+    }
+    strings.building_push_back('b');
+    equal(strings, model, "b");
+
+    // Every size-changing edit moves the substrings after it and the building substring.
+    strings.substring_insert(strings.begin(), 1, "abc");
+    model[0].insert(1, "abc");
+    equal(strings, model, "b");
+    strings.substring_erase(strings.begin() + 1, 0, 1);
+    model[1].erase(0, 1);
+    equal(strings, model, "b");
+    strings.substring_append(strings.begin() + 2, "xyz");
+    model[2] += "xyz";
+    equal(strings, model, "b");
+    strings.substring_replace(strings.begin() + 5, 0, 1, "long replacement");
+    model[5].replace(0, 1, "long replacement");
+    equal(strings, model, "b");
+    strings.substring_resize(strings.begin() + 10, 0);
+    model[10].clear();
+    equal(strings, model, "b");
+    strings.substring_resize(strings.begin() + 10, 4, 'r');
+    model[10].assign(4, 'r');
+    equal(strings, model, "b");
+    strings.substring_push_back(strings.begin() + 2999, 'e');
+    model[2999] += 'e';
+    equal(strings, model, "b");
+    strings.substring_clear(strings.begin() + 2999);
+    model[2999].clear();
+    equal(strings, model, "b");
+
+    // Node edits in the middle and at both ends.
+    strings.insert(strings.begin() + 1500, "middle");
+    model.insert(model.begin() + 1500, "middle");
+    equal(strings, model, "b");
+    strings.insert(strings.begin(), "front");
+    model.insert(model.begin(), "front");
+    equal(strings, model, "b");
+    strings.insert(strings.end(), "back");
+    model.push_back("back");
+    equal(strings, model, "b");
+    std::vector<std::string> range = {"r1", "", "r3"};
+    strings.insert(strings.end(), range.begin(), range.end());
+    model.insert(model.end(), range.begin(), range.end());
+    equal(strings, model, "b");
+    strings.insert(strings.begin() + 7, strings.begin() + 100, strings.begin() + 105);
+    range.assign(model.begin() + 100, model.begin() + 105);
+    model.insert(model.begin() + 7, range.begin(), range.end());
+    equal(strings, model, "b");
+    strings.erase(strings.begin() + 1, strings.begin() + 1200);
+    model.erase(model.begin() + 1, model.begin() + 1200);
+    equal(strings, model, "b");
+    strings.erase(strings.end() - 1);
+    model.pop_back();
+    equal(strings, model, "b");
+    strings.substring_insert(strings.begin(), 0, "again");
+    model[0].insert(0, "again");
+    equal(strings, model, "b");
+    // Shrinking leaves the characters of the dropped substrings in the building substring.
+    std::string dropped;
+    for (size_t i = 10; i < model.size(); ++i)
+        dropped += model[i];
+    strings.resize(10);
+    model.resize(10);
+    equal(strings, model, dropped + "b");
+    strings.building_clear();
+
+    // clear resets the building substring along with the nodes.
+    strings.building_push_back('c');
+    strings.clear();
+    equal(strings, {}, "");
+    strings.push_back("after");
+    strings.substring_append(strings.begin(), "!");
+    equal(strings, {"after!"}, "");
+}
+
+int main() {
+    edits<ktu::multi_string>();
+    edits<ktu::multi_string32>();
+    edits<ktu::packed_multi_string>();
+    return 0;
+}